@@ -0,0 +1,252 @@
+/**
+ * @file bej_gen.c
+ * @brief Synthetic dictionary and payload generator for benchmarks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bej_gen.h"
+
+void gen_buf_free(gen_buf* b){ free(b->d); b->d=NULL; b->n=b->cap=0; }
+
+static void gen_reserve(gen_buf* b, size_t k){
+    if(b->n+k <= b->cap) return;
+    size_t cap = b->cap ? b->cap : 256;
+    while(cap < b->n+k && cap < ((size_t)1 << 28)) cap *= 2;
+    if(cap < b->n+k) cap = b->n+k; /* very large buffers: grow exactly */
+    uint8_t* d = (uint8_t*)realloc(b->d, cap);
+    if(!d){ fprintf(stderr,"gen: out of memory\n"); exit(1); }
+    b->d=d; b->cap=cap;
+}
+
+void gen_u8(gen_buf* b, uint8_t v){ gen_reserve(b,1); b->d[b->n++]=v; }
+void gen_bytes(gen_buf* b, const void* p, size_t k){ gen_reserve(b,k); memcpy(b->d+b->n,p,k); b->n+=k; }
+void gen_u16le(gen_buf* b, uint16_t v){ gen_u8(b,(uint8_t)v); gen_u8(b,(uint8_t)(v>>8)); }
+void gen_u32le(gen_buf* b, uint32_t v){ gen_u16le(b,(uint16_t)v); gen_u16le(b,(uint16_t)(v>>16)); }
+
+void gen_nnint(gen_buf* b, uint64_t v){
+    uint8_t t[8]; uint8_t N=0;
+    if(v==0) t[N++]=0;
+    while(v){ t[N++]=(uint8_t)v; v>>=8; }
+    gen_u8(b,N); gen_bytes(b,t,N);
+}
+
+void gen_tuple(gen_buf* b, uint16_t seq, uint8_t fmt, const uint8_t* v, size_t vn){
+    gen_nnint(b,(uint64_t)seq<<1);
+    gen_u8(b,(uint8_t)(fmt<<4));
+    gen_nnint(b,vn);
+    gen_bytes(b,v,vn);
+}
+
+uint8_t gen_prop_fmt(unsigned i){
+    static const uint8_t cyc[5] = { BEJ_FMT_INT, BEJ_FMT_STRING, BEJ_FMT_ENUM, BEJ_FMT_SET, BEJ_FMT_ARRAY };
+    return cyc[i % 5];
+}
+
+static void put_entry(gen_buf* b, size_t at, int wide, uint8_t fmt, uint16_t seq, size_t child_off,
+                      uint16_t child_cnt, uint8_t name_len, size_t name_off){
+    uint8_t* q = b->d + at;
+    q[0]=(uint8_t)(fmt<<4);
+    q[1]=(uint8_t)seq; q[2]=(uint8_t)(seq>>8);
+    if(wide){
+        for(int i=0;i<4;i++) q[3+i]=(uint8_t)(child_off>>(8*i));
+        q[7]=(uint8_t)child_cnt; q[8]=(uint8_t)(child_cnt>>8);
+        q[9]=name_len;
+        for(int i=0;i<4;i++) q[10+i]=(uint8_t)(name_off>>(8*i));
+    }else{
+        q[3]=(uint8_t)child_off; q[4]=(uint8_t)(child_off>>8);
+        q[5]=(uint8_t)child_cnt; q[6]=(uint8_t)(child_cnt>>8);
+        q[7]=name_len;
+        q[8]=(uint8_t)name_off; q[9]=(uint8_t)(name_off>>8);
+    }
+}
+
+static void build_dict(gen_buf* out, unsigned nprops, int wide){
+    static const char* opts[3] = { "Enabled", "Disabled", "StandbyOffline" };
+    static const char* kids[2] = { "Channel", "Slot" };
+    size_t nent = 1 + (size_t)nprops + 3 + 2;
+    size_t esz = wide ? BEJ_DICT_WIDE_ENTRY_N : BEJ_DICT_ENTRY_N;
+    out->n = 0;
+    gen_u8(out,0x01); gen_u8(out,(uint8_t)(wide ? BEJ_DICT_FLAG_LOCAL_WIDE : 0));
+    gen_u16le(out,(uint16_t)nent);
+    gen_u32le(out,0); gen_u32le(out,0);
+    size_t eo = out->n;
+    gen_reserve(out, nent*esz); memset(out->d+eo, 0, nent*esz); out->n += nent*esz;
+
+    size_t opt_idx = 1 + (size_t)nprops, kid_idx = opt_idx + 3;
+    char name[32];
+    size_t off = out->n; gen_bytes(out,"Root",5);
+    put_entry(out, eo, wide, BEJ_FMT_SET, 0, eo+esz, (uint16_t)nprops, 5, off);
+    for(unsigned i=0;i<nprops;i++){
+        int k = snprintf(name,sizeof(name),"Prop%u",i);
+        off = out->n; gen_bytes(out,name,(size_t)k+1);
+        uint8_t fmt = gen_prop_fmt(i);
+        size_t co = 0; uint16_t cc = 0;
+        if(fmt==BEJ_FMT_ENUM){ co = eo + opt_idx*esz; cc = 3; }
+        if(fmt==BEJ_FMT_SET){  co = eo + kid_idx*esz; cc = 2; }
+        put_entry(out, eo+(1+(size_t)i)*esz, wide, fmt, (uint16_t)i, co, cc, (uint8_t)(k+1), off);
+    }
+    for(unsigned i=0;i<3;i++){
+        off = out->n; gen_bytes(out,opts[i],strlen(opts[i])+1);
+        put_entry(out, eo+(opt_idx+i)*esz, wide, BEJ_FMT_NULL, (uint16_t)i, 0, 0, (uint8_t)(strlen(opts[i])+1), off);
+    }
+    for(unsigned i=0;i<2;i++){
+        off = out->n; gen_bytes(out,kids[i],strlen(kids[i])+1);
+        put_entry(out, eo+(kid_idx+i)*esz, wide, BEJ_FMT_INT, (uint16_t)i, 0, 0, (uint8_t)(strlen(kids[i])+1), off);
+    }
+    out->d[8]=(uint8_t)out->n; out->d[9]=(uint8_t)(out->n>>8); out->d[10]=(uint8_t)(out->n>>16); out->d[11]=(uint8_t)(out->n>>24);
+}
+
+int gen_dict(gen_buf* out, unsigned nprops){
+    if(1 + (size_t)nprops + 5 > 0xFFFF) return 0; /* EntryCount is 16-bit */
+    build_dict(out, nprops, 0);
+    /* Table 31 offsets are 16-bit: switch to wide entries past 64 KiB */
+    if(out->n > 0xFFFF) build_dict(out, nprops, 1);
+    return 1;
+}
+
+static uint64_t xs(uint64_t* s){ *s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17; return *s; }
+
+static void gen_int(gen_buf* v, uint64_t x){
+    uint8_t t[8]; size_t N=1;
+    t[0]=(uint8_t)x;
+    for(size_t i=1;i<4;i++){ t[i]=(uint8_t)(x>>(8*i)); if(t[i]) N=i+1; }
+    gen_bytes(v,t,N);
+}
+
+void gen_payload(gen_buf* out, unsigned nprops, uint64_t seed){
+    uint64_t s = seed*0x9E3779B97F4A7C15ULL + 1;
+    gen_buf root = {0}, v = {0}, sub = {0};
+    gen_nnint(&root, nprops);
+    for(unsigned i=0;i<nprops;i++){
+        uint8_t fmt = gen_prop_fmt(i);
+        v.n = 0;
+        if(fmt==BEJ_FMT_INT){
+            gen_int(&v, xs(&s) & 0xFFFFFF);
+        }else if(fmt==BEJ_FMT_STRING){
+            char t[32]; int k = snprintf(t,sizeof(t),"val-%08llx",(unsigned long long)(xs(&s) & 0xFFFFFFFFu));
+            gen_bytes(&v,t,(size_t)k+1);
+        }else if(fmt==BEJ_FMT_ENUM){
+            gen_nnint(&v, xs(&s) % 3);
+        }else if(fmt==BEJ_FMT_SET){
+            gen_nnint(&v, 2);
+            for(uint16_t k=0;k<2;k++){ sub.n=0; gen_int(&sub, xs(&s) & 0xFF); gen_tuple(&v,k,BEJ_FMT_INT,sub.d,sub.n); }
+        }else{
+            gen_nnint(&v, 4);
+            for(uint16_t k=0;k<4;k++){ sub.n=0; gen_int(&sub, xs(&s) & 0xFFFF); gen_tuple(&v,k,BEJ_FMT_INT,sub.d,sub.n); }
+        }
+        gen_tuple(&root, (uint16_t)i, fmt, v.d, v.n);
+    }
+    out->n = 0;
+    gen_u32le(out,0xF1F0F000u); gen_u16le(out,0); gen_u8(out,0);
+    gen_tuple(out, 0, BEJ_FMT_SET, root.d, root.n);
+    gen_buf_free(&root); gen_buf_free(&v); gen_buf_free(&sub);
+}
+
+void gen_payload_array(gen_buf* out, uint64_t nelem, uint64_t maxval, uint64_t seed){
+    uint64_t s = seed*0x9E3779B97F4A7C15ULL + 1;
+    gen_buf root = {0}, v = {0}, sub = {0};
+    gen_nnint(&v, nelem);
+    for(uint64_t k=0;k<nelem;k++){
+        /* Element sequence numbers are array indexes (past 16 bits for big arrays) */
+        sub.n = 0; gen_int(&sub, maxval ? xs(&s) % maxval : 0);
+        gen_nnint(&v, k<<1); gen_u8(&v, (uint8_t)(BEJ_FMT_INT<<4)); gen_nnint(&v, sub.n); gen_bytes(&v, sub.d, sub.n);
+    }
+    gen_nnint(&root, 1);
+    gen_tuple(&root, 4, BEJ_FMT_ARRAY, v.d, v.n);
+    out->n = 0;
+    gen_u32le(out,0xF1F0F000u); gen_u16le(out,0); gen_u8(out,0);
+    gen_tuple(out, 0, BEJ_FMT_SET, root.d, root.n);
+    gen_buf_free(&root); gen_buf_free(&v); gen_buf_free(&sub);
+}
+
+void gen_payload_big(gen_buf* out, unsigned nprops, uint64_t big_n, uint64_t seed){
+    /* Generate the normal payload, then splice a big_n-byte value in place of Prop1 (String) */
+    gen_buf small = {0}, hdr = {0}, cntb = {0};
+    gen_payload(&small, nprops < 2 ? 2 : nprops, seed);
+    bej_br br; bej_br_init(&br, small.d, small.n);
+    uint64_t S, L, cnt; uint8_t F;
+    bej_br_seek(&br, 7); bej_read_nnint(&br,&S); bej_br_u8(&br,&F); bej_read_nnint(&br,&L);
+    bej_read_nnint(&br,&cnt);
+    size_t prop0 = br.p;
+    bej_read_nnint(&br,&S); bej_br_u8(&br,&F); bej_read_nnint(&br,&L); bej_br_skip(&br,L);
+    size_t prop1 = br.p;
+    bej_read_nnint(&br,&S); bej_br_u8(&br,&F); bej_read_nnint(&br,&L); bej_br_skip(&br,L);
+    size_t prop2 = br.p;
+
+    gen_nnint(&hdr, 1u<<1); gen_u8(&hdr, BEJ_FMT_STRING<<4); gen_nnint(&hdr, big_n);
+    gen_nnint(&cntb, cnt);
+    uint64_t rootv = cntb.n + (prop1 - prop0) + hdr.n + big_n + (small.n - prop2);
+
+    out->n = 0;
+    gen_reserve(out, 32 + (size_t)rootv);
+    gen_u32le(out,0xF1F0F000u); gen_u16le(out,0); gen_u8(out,0);
+    gen_nnint(out, 0); gen_u8(out, BEJ_FMT_SET<<4); gen_nnint(out, rootv);
+    gen_bytes(out, cntb.d, cntb.n);
+    gen_bytes(out, small.d + prop0, prop1 - prop0);
+    gen_bytes(out, hdr.d, hdr.n);
+    memset(out->d + out->n, 'a', (size_t)big_n); out->n += (size_t)big_n;
+    gen_bytes(out, small.d + prop2, small.n - prop2);
+    gen_buf_free(&small); gen_buf_free(&hdr); gen_buf_free(&cntb);
+}
+
+static void gen_dict_value(gen_buf* v, const bej_dict* D, const bej_dict_entry* de, uint8_t fmt, int depth, uint64_t* s);
+
+static void gen_dict_set(gen_buf* v, const bej_dict* D, bej_cluster c, int depth, uint64_t* s){
+    gen_buf body = {0}, sub = {0};
+    uint64_t cnt = 0;
+    uint32_t end = c.start_idx + c.count;
+    if(end > D->n) end = (uint32_t)D->n;
+    for(uint32_t i=c.start_idx;i<end;i++){
+        if(xs(s) % 4 == 0) continue;
+        const bej_dict_entry* de = &D->ent[i];
+        uint8_t fmt = (uint8_t)(de->fmt >> 4);
+        if(xs(s) % 16 == 0) fmt = (uint8_t)(xs(s) % 8);   /* tuple format differs from the schema */
+        sub.n = 0; gen_dict_value(&sub, D, de, fmt, depth, s);
+        gen_tuple(&body, de->seq, fmt, sub.d, sub.n); cnt++;
+        if(xs(s) % 8 == 0){   /* annotation: skipped by the decoders */
+            gen_nnint(&body, ((uint64_t)de->seq << 1) | 1u); gen_u8(&body, BEJ_FMT_STRING<<4);
+            gen_nnint(&body, 2); gen_bytes(&body, "a", 2); cnt++;
+        }
+    }
+    if(xs(s) % 4 == 0){ gen_tuple(&body, 0xFFF0, BEJ_FMT_INT, (const uint8_t*)"\x2a", 1); cnt++; }
+    gen_nnint(v, cnt); gen_bytes(v, body.d, body.n);
+    gen_buf_free(&body); gen_buf_free(&sub);
+}
+
+static void gen_dict_value(gen_buf* v, const bej_dict* D, const bej_dict_entry* de, uint8_t fmt, int depth, uint64_t* s){
+    static const char* strs[] = { "plain", "with \"quotes\"", "back\\slash", "line\nbreak", "" };
+    if(fmt==BEJ_FMT_INT){
+        gen_int(v, xs(s));
+    }else if(fmt==BEJ_FMT_STRING){
+        const char* t = strs[xs(s) % 5]; gen_bytes(v, t, strlen(t)+1);
+    }else if(fmt==BEJ_FMT_ENUM){
+        gen_nnint(v, xs(s) % ((uint64_t)de->child_cnt + 2));
+    }else if(fmt==BEJ_FMT_SET){
+        if(depth < 4) gen_dict_set(v, D, bej_dict_child_cluster(D, de), depth+1, s);
+        else gen_nnint(v, 0);
+    }else if(fmt==BEJ_FMT_ARRAY){
+        gen_buf sub = {0};
+        uint64_t n = xs(s) % 4;
+        gen_nnint(v, n);
+        for(uint64_t k=0;k<n;k++){
+            uint8_t ef = (xs(s) % 3 == 0) ? BEJ_FMT_STRING : BEJ_FMT_INT;
+            sub.n = 0; gen_dict_value(&sub, D, de, ef, depth, s);
+            gen_tuple(v, (uint16_t)k, ef, sub.d, sub.n);
+        }
+        gen_buf_free(&sub);
+    }else{
+        gen_u8(v, (uint8_t)xs(s));
+    }
+}
+
+void gen_payload_dict(gen_buf* out, const bej_dict* D, uint64_t seed){
+    uint64_t s = seed*0x9E3779B97F4A7C15ULL + 1;
+    gen_buf root = {0};
+    gen_dict_set(&root, D, bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL), 0, &s);
+    out->n = 0;
+    gen_u32le(out,0xF1F0F000u); gen_u16le(out,0); gen_u8(out,0);
+    gen_tuple(out, 0, BEJ_FMT_SET, root.d, root.n);
+    gen_buf_free(&root);
+}
@@ -0,0 +1,60 @@
+#ifndef BEJ_GEN_H_
+#define BEJ_GEN_H_
+
+/**
+ * @file bej_gen.h
+ * @brief Synthetic dictionary and payload generator for benchmarks.
+ *
+ * The generated schema is a root Set with @c nprops members named
+ * "Prop<i>" whose formats cycle through Int, String, Enum, Set and Array.
+ * Enum members share one option cluster (Enabled, Disabled, StandbyOffline);
+ * Set members share one child cluster (Channel:int, Slot:int).
+ * Dictionaries that outgrow the 16-bit Table 31 offsets are emitted with
+ * wide entries (@ref BEJ_DICT_FLAG_LOCAL_WIDE; load those with
+ * bej_dict_load_local()).
+ */
+
+#include "bej.h"
+
+/** Growable byte buffer. */
+typedef struct {
+    uint8_t* d;
+    size_t   n;
+    size_t   cap;
+} gen_buf;
+
+void gen_buf_free(gen_buf* b);
+void gen_u8(gen_buf* b, uint8_t v);
+void gen_bytes(gen_buf* b, const void* p, size_t k);
+void gen_u16le(gen_buf* b, uint16_t v);
+void gen_u32le(gen_buf* b, uint32_t v);
+void gen_nnint(gen_buf* b, uint64_t v);
+void gen_tuple(gen_buf* b, uint16_t seq, uint8_t fmt, const uint8_t* v, size_t vn);
+
+/** Format of generated property @p i. */
+uint8_t gen_prop_fmt(unsigned i);
+
+/** Build the synthetic dictionary with @p nprops root members into @p out (0 if nprops is too large). */
+int  gen_dict(gen_buf* out, unsigned nprops);
+
+/** Build a payload for gen_dict(@p nprops); values are derived from @p seed. */
+void gen_payload(gen_buf* out, unsigned nprops, uint64_t seed);
+
+/** Like gen_payload(), but Prop1 is a String of @p big_n bytes (exercises lengths past INT_MAX). */
+void gen_payload_big(gen_buf* out, unsigned nprops, uint64_t big_n, uint64_t seed);
+
+/**
+ * Build a payload for gen_dict(5) whose only member is Prop4, an Array of
+ * @p nelem Integers drawn from [0, @p maxval) in minimal-width encoding.
+ */
+void gen_payload_array(gen_buf* out, uint64_t nelem, uint64_t maxval, uint64_t seed);
+
+/**
+ * Build a random payload for an arbitrary dictionary @p D: members of every
+ * cluster reachable from the root (Sets up to a few levels deep), values of
+ * the dictionary format, plus annotations, unknown sequence numbers,
+ * out-of-range enum ordinals and strings that need escaping.
+ */
+void gen_payload_dict(gen_buf* out, const bej_dict* D, uint64_t seed);
+
+#endif /* BEJ_GEN_H_ */
@@ -0,0 +1,412 @@
+/**
+ * @file bench_bej.c
+ * @brief Micro-benchmarks for the BEJ library on generated payloads.
+ *
+ * Usage: bench_bej [name ...]   (no argument runs every benchmark)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bej.h"
+#include "bej_gen.h"
+#include "bej_memory_v1.h"
+
+static double now_sec(void){
+    struct timespec ts; timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t g_rng = 0x2545F4914F6CDD1DULL;
+static uint64_t rnd(void){ g_rng ^= g_rng << 13; g_rng ^= g_rng >> 7; g_rng ^= g_rng << 17; return g_rng; }
+
+/* ------------------------------------------------------------------ */
+/* cache: decode-to-memory vs bej_cache_decode at several duplicate ratios */
+
+static void bench_cache(void){
+    enum { NPROPS = 40, NREQ = 20000 };
+    static const double ratios[] = { 0.0, 0.5, 0.9, 0.99 };
+    gen_buf db = {0}; gen_dict(&db, NPROPS);
+    bej_dict D; if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"cache: dict\n"); return; }
+
+    printf("cache: %d requests, %d properties per payload, 64 MiB limit\n", NREQ, NPROPS);
+    printf("  %-6s %12s %12s %8s %8s\n", "dup", "decode/s", "cached/s", "speedup", "hits");
+    for(size_t r=0;r<sizeof(ratios)/sizeof(ratios[0]);r++){
+        /* Request stream: duplicates pick an earlier payload uniformly */
+        gen_buf* uniq = (gen_buf*)calloc(NREQ, sizeof(gen_buf));
+        size_t* req = (size_t*)malloc(NREQ*sizeof(size_t));
+        size_t nu = 0;
+        for(size_t k=0;k<NREQ;k++){
+            if(nu && (double)(rnd() % 10000) < ratios[r]*10000.0) req[k] = (size_t)(rnd() % nu);
+            else { gen_payload(&uniq[nu], NPROPS, (uint64_t)nu + r*NREQ); req[k] = nu++; }
+        }
+
+        double t0 = now_sec();
+        for(size_t k=0;k<NREQ;k++){
+            char* js; size_t jn;
+            if(!bej_decode_to_mem(uniq[req[k]].d, uniq[req[k]].n, &D, &js, &jn)) fprintf(stderr,"decode failed\n");
+            free(js);
+        }
+        double t1 = now_sec();
+        bej_cache* c = bej_cache_new((size_t)64 << 20);
+        for(size_t k=0;k<NREQ;k++){
+            const char* js; size_t jn;
+            if(!bej_cache_decode(c, uniq[req[k]].d, uniq[req[k]].n, &D, &js, &jn)) fprintf(stderr,"decode failed\n");
+        }
+        double t2 = now_sec();
+        bej_cache_stats st; bej_cache_get_stats(c, &st);
+        printf("  %-6.2f %12.0f %12.0f %7.2fx %7.1f%%\n", ratios[r],
+               NREQ/(t1-t0), NREQ/(t2-t1), (t1-t0)/(t2-t1), 100.0*(double)st.hits/NREQ);
+        bej_cache_free(c);
+        for(size_t k=0;k<nu;k++) gen_buf_free(&uniq[k]);
+        free(uniq); free(req);
+    }
+    bej_dict_free(&D); gen_buf_free(&db);
+}
+
+/* ------------------------------------------------------------------ */
+/* keys: key-heavy payloads (many small members) decoded to memory */
+
+static void bench_keys(void){
+    enum { NPROPS = 2000, NPAY = 16, ROUNDS = 50 };
+    gen_buf db = {0}; gen_dict(&db, NPROPS);
+    bej_dict D; if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"keys: dict\n"); return; }
+    gen_buf pay[NPAY]; memset(pay, 0, sizeof(pay));
+    size_t in_n = 0;
+    for(size_t k=0;k<NPAY;k++){ gen_payload(&pay[k], NPROPS, k+1); in_n += pay[k].n; }
+
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    double t0 = now_sec();
+    for(int r=0;r<ROUNDS;r++) for(size_t k=0;k<NPAY;k++){ jw.len=0; jw.ind=0; jw.need_comma=0; bej_decode_to_jsonw(&jw, pay[k].d, pay[k].n, &D); }
+    double t1 = now_sec();
+    /* members per payload: the root members plus two in each Set member */
+    double keys = (double)NPAY*ROUNDS*(NPROPS + 2*(NPROPS/5));
+    printf("keys: %d members per payload, %.0f bytes avg\n", NPROPS, (double)in_n/NPAY);
+    printf("  decode %8.1f MB/s in, %6.1f M keys/s\n", (double)in_n*ROUNDS/(t1-t0)/1e6, keys/(t1-t0)/1e6);
+    free(jw.buf);
+    for(size_t k=0;k<NPAY;k++) gen_buf_free(&pay[k]);
+    bej_dict_free(&D); gen_buf_free(&db);
+}
+
+/* ------------------------------------------------------------------ */
+/* iov: payload split into transport-sized segments, coalesce+decode vs in-place */
+
+static void bench_iov(void){
+    enum { NPROPS = 200, NPAY = 64, ROUNDS = 40 };
+    static const size_t segs[] = { 64, 256, 4096 };
+    gen_buf db = {0}; gen_dict(&db, NPROPS);
+    bej_dict D; if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"iov: dict\n"); return; }
+    gen_buf pay[NPAY]; memset(pay, 0, sizeof(pay));
+    size_t in_n = 0;
+    for(size_t k=0;k<NPAY;k++){ gen_payload_big(&pay[k], NPROPS, 1000, k+1); in_n += pay[k].n; }
+
+    printf("iov: %d payloads, %.0f bytes avg (one 1000-byte string each)\n", NPAY, (double)in_n/NPAY);
+    printf("  %-8s %14s %14s %8s\n", "segment", "coalesce MB/s", "in-place MB/s", "speedup");
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    for(size_t si=0; si<sizeof(segs)/sizeof(segs[0]); si++){
+        /* Segment lists as a transport would hand them over (each segment its own buffer) */
+        bej_iov* lists[NPAY]; size_t nl[NPAY];
+        for(size_t k=0;k<NPAY;k++){
+            size_t ns = (pay[k].n + segs[si] - 1) / segs[si];
+            lists[k] = (bej_iov*)malloc(ns * sizeof(bej_iov)); nl[k] = ns;
+            for(size_t q=0;q<ns;q++){
+                size_t o = q*segs[si], len = pay[k].n - o < segs[si] ? pay[k].n - o : segs[si];
+                uint8_t* b = (uint8_t*)malloc(len); memcpy(b, pay[k].d + o, len);
+                lists[k][q].d = b; lists[k][q].n = len;
+            }
+        }
+        double t0 = now_sec();
+        for(int r=0;r<ROUNDS;r++) for(size_t k=0;k<NPAY;k++){
+            size_t tot = 0; for(size_t q=0;q<nl[k];q++) tot += lists[k][q].n;
+            uint8_t* flat = (uint8_t*)malloc(tot); size_t o = 0;
+            for(size_t q=0;q<nl[k];q++){ memcpy(flat + o, lists[k][q].d, lists[k][q].n); o += lists[k][q].n; }
+            jw.len=0; jw.ind=0; jw.need_comma=0;
+            bej_decode_to_jsonw(&jw, flat, tot, &D);
+            free(flat);
+        }
+        double t1 = now_sec();
+        for(int r=0;r<ROUNDS;r++) for(size_t k=0;k<NPAY;k++){
+            jw.len=0; jw.ind=0; jw.need_comma=0;
+            bej_decode_iov_to_jsonw(&jw, lists[k], nl[k], &D);
+        }
+        double t2 = now_sec();
+        double mb = (double)in_n*ROUNDS/1e6;
+        printf("  %-8zu %14.1f %14.1f %7.2fx\n", segs[si], mb/(t1-t0), mb/(t2-t1), (t1-t0)/(t2-t1));
+        for(size_t k=0;k<NPAY;k++){ for(size_t q=0;q<nl[k];q++) free((void*)lists[k][q].d); free(lists[k]); }
+    }
+    free(jw.buf);
+    for(size_t k=0;k<NPAY;k++) gen_buf_free(&pay[k]);
+    bej_dict_free(&D); gen_buf_free(&db);
+}
+
+/* ------------------------------------------------------------------ */
+/* large: >64 KiB (wide) dictionary and a >2 GiB payload */
+
+static FILE* null_sink(void){
+#ifdef _WIN32
+    return fopen("NUL", "wb");
+#else
+    return fopen("/dev/null", "wb");
+#endif
+}
+
+static void bench_large(void){
+    enum { NPROPS_BIG = 8000, NPROPS = 40, ROUNDS = 20 };
+    gen_buf db = {0}; gen_dict(&db, NPROPS_BIG);
+    bej_dict D; if(!bej_dict_load_local(db.d, db.n, &D)){ fprintf(stderr,"large: dict\n"); return; }
+    gen_buf pb = {0}; gen_payload(&pb, NPROPS_BIG, 1);
+
+    double t0 = now_sec(); size_t out_n = 0;
+    for(int r=0;r<ROUNDS;r++){
+        char* js; size_t jn;
+        if(!bej_decode_to_mem(pb.d, pb.n, &D, &js, &jn)){ fprintf(stderr,"large: decode failed\n"); break; }
+        out_n = jn; free(js);
+    }
+    double t1 = now_sec();
+    printf("large: dictionary %llu bytes (%s entries), payload %llu bytes -> %llu bytes JSON\n",
+           (unsigned long long)db.n, D.ent_size==BEJ_DICT_WIDE_ENTRY_N ? "wide" : "Table 31",
+           (unsigned long long)pb.n, (unsigned long long)out_n);
+    printf("  decode: %.1f MB/s in\n", (double)pb.n*ROUNDS/(t1-t0)/1e6);
+    bej_dict_free(&D); gen_buf_free(&db); gen_buf_free(&pb);
+
+    /* One String value longer than INT_MAX */
+    uint64_t big = ((uint64_t)1 << 31) + ((uint64_t)64 << 20);
+    gen_dict(&db, NPROPS);
+    if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"large: dict\n"); return; }
+    gen_payload_big(&pb, NPROPS, big, 1);
+    FILE* f = null_sink();
+    bej_pred P; bej_pred_compile(&P, &D, "Prop10>=0");
+    t0 = now_sec();
+    int m = bej_pred_eval(&P, pb.d, pb.n);
+    t1 = now_sec();
+    int ok = f && bej_decode_to_json(f, pb.d, pb.n, &D);
+    double t2 = now_sec();
+    printf("  payload %llu bytes: predicate past the big value %s in %.3f ms, decode %s in %.2f s (%.1f MB/s)\n",
+           (unsigned long long)pb.n, m==1 ? "matched" : "FAILED", (t1-t0)*1e3,
+           ok ? "ok" : "FAILED", t2-t1, (double)pb.n/(t2-t1)/1e6);
+    if(f) fclose(f);
+    bej_dict_free(&D); gen_buf_free(&db); gen_buf_free(&pb);
+}
+
+/* ------------------------------------------------------------------ */
+/* codegen: generic decoder vs the decoder generated from Memory_v1.bin */
+
+static int load_data(const char* name, uint8_t** out, size_t* out_n){
+    char path[1024]; snprintf(path, sizeof(path), "%s/%s", BEJ_DATA_DIR, name);
+    *out=NULL; *out_n=0; FILE* f=fopen(path,"rb"); if(!f) return 0;
+    fseek(f,0,SEEK_END); long sz=ftell(f); fseek(f,0,SEEK_SET);
+    if(sz<=0){ fclose(f); return 0; }
+    uint8_t* buf=(uint8_t*)malloc((size_t)sz);
+    if(!buf || fread(buf,1,(size_t)sz,f)!=(size_t)sz){ free(buf); fclose(f); return 0; }
+    fclose(f); *out=buf; *out_n=(size_t)sz; return 1;
+}
+
+static void bench_codegen(void){
+    enum { NPAY = 1000, ROUNDS = 20 };
+    uint8_t* sb; size_t sn; bej_dict D;
+    if(!load_data("Memory_v1.bin", &sb, &sn) || !bej_dict_load(sb, sn, &D)){ fprintf(stderr,"codegen: dict\n"); return; }
+    gen_buf* pay = (gen_buf*)calloc(NPAY, sizeof(gen_buf));
+    size_t in_n = 0, diff = 0;
+    for(size_t k=0;k<NPAY;k++){
+        gen_payload_dict(&pay[k], &D, k+1); in_n += pay[k].n;
+        char *a, *b; size_t an, bn;
+        int ra = bej_decode_to_mem(pay[k].d, pay[k].n, &D, &a, &an);
+        int rb = bej_memory_v1_decode_to_mem(pay[k].d, pay[k].n, &b, &bn);
+        if(ra!=rb || (ra && (an!=bn || memcmp(a,b,an)!=0))) diff++;
+        if(ra) free(a);
+        if(rb) free(b);
+    }
+
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    double t0 = now_sec();
+    for(int r=0;r<ROUNDS;r++) for(size_t k=0;k<NPAY;k++){ jw.len=0; jw.ind=0; jw.need_comma=0; bej_decode_to_jsonw(&jw, pay[k].d, pay[k].n, &D); }
+    double t1 = now_sec();
+    for(int r=0;r<ROUNDS;r++) for(size_t k=0;k<NPAY;k++){ jw.len=0; jw.ind=0; jw.need_comma=0; bej_memory_v1_decode_to_jsonw(&jw, pay[k].d, pay[k].n); }
+    double t2 = now_sec();
+    free(jw.buf);
+
+    double mb = (double)in_n*ROUNDS/1e6;
+    printf("codegen: %d Memory_v1 payloads (%.0f bytes avg), %llu output mismatches\n",
+           NPAY, (double)in_n/NPAY, (unsigned long long)diff);
+    printf("  generic   %8.1f MB/s in\n", mb/(t1-t0));
+    printf("  generated %8.1f MB/s in  (%.2fx)\n", mb/(t2-t1), (t1-t0)/(t2-t1));
+    for(size_t k=0;k<NPAY;k++) gen_buf_free(&pay[k]);
+    free(pay); bej_dict_free(&D); free(sb);
+}
+
+/* ------------------------------------------------------------------ */
+/* columnar: batch of Memory_v1 payloads -> columns vs -> JSON text */
+
+static void bench_columnar(void){
+    enum { NPAY = 10000 };
+    uint8_t* sb; size_t sn; bej_dict D;
+    if(!load_data("Memory_v1.bin", &sb, &sn) || !bej_dict_load(sb, sn, &D)){ fprintf(stderr,"columnar: dict\n"); return; }
+    gen_buf* pay = (gen_buf*)calloc(NPAY, sizeof(gen_buf));
+    size_t in_n = 0;
+    for(size_t k=0;k<NPAY;k++){ gen_payload_dict(&pay[k], &D, k+1); in_n += pay[k].n; }
+
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    size_t json_n = 0;
+    double t0 = now_sec();
+    for(size_t k=0;k<NPAY;k++){ jw.len=0; jw.ind=0; jw.need_comma=0; bej_decode_to_jsonw(&jw, pay[k].d, pay[k].n, &D); json_n += jw.len; }
+    double t1 = now_sec();
+    bej_colset C; size_t rows = 0;
+    if(bej_colset_init(&C, &D)){
+        for(size_t k=0;k<NPAY;k++) rows += (size_t)bej_colset_add(&C, pay[k].d, pay[k].n);
+    }
+    double t2 = now_sec();
+    FILE* f = null_sink();
+    int ok = f && bej_colset_write(&C, f);
+    double t3 = now_sec();
+    if(f) fclose(f);
+
+    double mb = (double)in_n/1e6;
+    printf("columnar: %d Memory_v1 payloads, %.1f MB in, %zu columns\n", NPAY, mb, C.ncol);
+    printf("  json      %8.1f MB/s in  (%.1f MB of text to re-parse)\n", mb/(t1-t0), (double)json_n/1e6);
+    printf("  columns   %8.1f MB/s in  (%.2fx), %zu rows, file write %s in %.1f ms\n",
+           mb/(t2-t1), (t1-t0)/(t2-t1), rows, ok ? "ok" : "FAILED", (t3-t2)*1e3);
+    bej_colset_free(&C);
+    free(jw.buf);
+    for(size_t k=0;k<NPAY;k++) gen_buf_free(&pay[k]);
+    free(pay); bej_dict_free(&D); free(sb);
+}
+
+/* ------------------------------------------------------------------ */
+/* exact: growable sink vs sizing pass + one exactly sized buffer */
+
+static void bench_exact(void){
+    static const struct { const char* what; unsigned nprops; uint64_t big; int npay, rounds; } cases[] = {
+        { "small",  20,      0, 256, 400 },
+        { "keys",   2000,    0, 16,  50 },
+        { "string", 200, 1u<<20, 8,   20 },
+    };
+    printf("exact: bej_decode_to_mem (realloc growth) vs bej_decode_to_mem_exact (size, then render)\n");
+    printf("  %-7s %10s %6s %11s %11s %11s %8s %8s\n",
+           "payload", "json bytes", "grows", "grow us", "size us", "exact us", "size %", "speedup");
+    for(size_t ci=0; ci<sizeof(cases)/sizeof(cases[0]); ci++){
+        int np = cases[ci].npay, R = cases[ci].rounds;
+        gen_buf db = {0}; gen_dict(&db, cases[ci].nprops);
+        bej_dict D; if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"exact: dict\n"); return; }
+        gen_buf* pay = (gen_buf*)calloc((size_t)np, sizeof(gen_buf));
+        for(int k=0;k<np;k++){
+            if(cases[ci].big) gen_payload_big(&pay[k], cases[ci].nprops, cases[ci].big, (uint64_t)k+1);
+            else gen_payload(&pay[k], cases[ci].nprops, (uint64_t)k+1);
+        }
+        size_t out_n = 0, grows = 0, ok = 0;
+        for(int k=0;k<np;k++){
+            size_t n = 0; ok += (size_t)bej_decode_size(pay[k].d, pay[k].n, &D, &n); out_n += n;
+            for(size_t cap=256; cap<n; cap*=2) grows++;   /* reallocs after the first 256-byte block */
+        }
+        double t0 = now_sec();
+        for(int r=0;r<R;r++) for(int k=0;k<np;k++){
+            char* o; size_t n; if(bej_decode_to_mem(pay[k].d, pay[k].n, &D, &o, &n)) free(o);
+        }
+        double t1 = now_sec();
+        for(int r=0;r<R;r++) for(int k=0;k<np;k++){ size_t n; bej_decode_size(pay[k].d, pay[k].n, &D, &n); }
+        double t2 = now_sec();
+        for(int r=0;r<R;r++) for(int k=0;k<np;k++){
+            char* o; size_t n; if(bej_decode_to_mem_exact(pay[k].d, pay[k].n, &D, &o, &n)) free(o);
+        }
+        double t3 = now_sec();
+        double per = 1e6/((double)R*np);
+        printf("  %-7s %10.0f %6.1f %11.2f %11.2f %11.2f %7.1f%% %7.2fx%s\n",
+               cases[ci].what, (double)out_n/np, (double)grows/np, (t1-t0)*per, (t2-t1)*per, (t3-t2)*per,
+               100.0*(t2-t1)/(t1-t0), (t1-t0)/(t3-t2), ok==(size_t)np ? "" : "  (decode FAILED)");
+        for(int k=0;k<np;k++) gen_buf_free(&pay[k]);
+        free(pay); bej_dict_free(&D); gen_buf_free(&db);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* arrays: one Integer Array of 10^3..10^6 elements decoded to memory */
+
+static void bench_arrays(void){
+    static const uint64_t maxv[] = { 100, 100000, 4000000000u };
+    gen_buf db = {0}; gen_dict(&db, 5);
+    bej_dict D; if(!bej_dict_load(db.d, db.n, &D)){ fprintf(stderr,"arrays: dict\n"); return; }
+    printf("arrays: Integer Array, values in [0, max), decode to memory\n");
+    printf("  %-9s %-14s %10s %12s %12s\n", "elements", "max", "bytes in", "M elem/s", "MB/s in");
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    gen_buf pay = {0};
+    for(uint64_t n=1000; n<=1000000; n*=10){
+        for(size_t vi=0; vi<sizeof(maxv)/sizeof(maxv[0]); vi++){
+            gen_payload_array(&pay, n, maxv[vi], n+vi);
+            int rounds = (int)(4000000/n); if(rounds < 3) rounds = 3;
+            int ok = 1;
+            double t0 = now_sec();
+            for(int r=0;r<rounds;r++){ jw.len=0; jw.ind=0; jw.need_comma=0; ok &= bej_decode_to_jsonw(&jw, pay.d, pay.n, &D); }
+            double t1 = now_sec();
+            printf("  %-9llu %-14llu %10zu %12.1f %12.1f%s\n", (unsigned long long)n, (unsigned long long)maxv[vi], pay.n,
+                   (double)n*rounds/(t1-t0)/1e6, (double)pay.n*rounds/(t1-t0)/1e6, ok ? "" : "  (decode FAILED)");
+        }
+    }
+    free(jw.buf); gen_buf_free(&pay);
+    bej_dict_free(&D); gen_buf_free(&db);
+}
+
+/* ------------------------------------------------------------------ */
+/* prom: batch -> OpenMetrics text directly vs the JSON text stage */
+
+static void bench_prom(void){
+    enum { NPAY = 10000 };
+    uint8_t *sb, *mb; size_t sn, mn; bej_dict D;
+    if(!load_data("Memory_v1.bin", &sb, &sn) || !bej_dict_load(sb, sn, &D)){ fprintf(stderr,"prom: dict\n"); return; }
+    if(!load_data("Memory_v1.prom", &mb, &mn)){ fprintf(stderr,"prom: map\n"); bej_dict_free(&D); free(sb); return; }
+    size_t line = 0;
+    bej_prom* P = bej_prom_new(&D, (const char*)mb, mn, &line);
+    if(!P){ fprintf(stderr,"prom: map line %zu\n", line); free(mb); bej_dict_free(&D); free(sb); return; }
+    gen_buf* pay = (gen_buf*)calloc(NPAY, sizeof(gen_buf));
+    size_t in_n = 0;
+    for(size_t k=0;k<NPAY;k++){ gen_payload_dict(&pay[k], &D, k+1); in_n += pay[k].n; }
+
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    size_t json_n = 0;
+    double t0 = now_sec();
+    for(size_t k=0;k<NPAY;k++){ jw.len=0; jw.ind=0; jw.need_comma=0; bej_decode_to_jsonw(&jw, pay[k].d, pay[k].n, &D); json_n += jw.len; }
+    double t1 = now_sec();
+    size_t added = 0;
+    for(size_t k=0;k<NPAY;k++){
+        char lab[32]; snprintf(lab, sizeof(lab), "dimm=\"%zu\"", k);
+        added += (size_t)bej_prom_add(P, pay[k].d, pay[k].n, lab);
+    }
+    size_t samples = bej_prom_pending(P);
+    FILE* f = null_sink();
+    int ok = f && bej_prom_write(P, f);
+    double t2 = now_sec();
+    if(f) fclose(f);
+
+    double mbs = (double)in_n/1e6;
+    printf("prom: %d Memory_v1 payloads, %.1f MB in, mapping Memory_v1.prom\n", NPAY, mbs);
+    printf("  json      %8.1f MB/s in  (%.1f MB of text, before any JSON parsing)\n", mbs/(t1-t0), (double)json_n/1e6);
+    printf("  openmetrics %6.1f MB/s in  (%.2fx), %zu payloads, %zu samples, write %s\n",
+           mbs/(t2-t1), (t1-t0)/(t2-t1), added, samples, ok ? "ok" : "FAILED");
+    free(jw.buf);
+    for(size_t k=0;k<NPAY;k++) gen_buf_free(&pay[k]);
+    free(pay); bej_prom_free(P); free(mb); bej_dict_free(&D); free(sb);
+}
+
+/* ------------------------------------------------------------------ */
+
+typedef struct { const char* name; void (*fn)(void); int heavy; } bench_entry;
+static const bench_entry g_benches[] = {
+    { "cache", bench_cache, 0 },
+    { "keys", bench_keys, 0 },
+    { "iov", bench_iov, 0 },
+    { "codegen", bench_codegen, 0 },
+    { "columnar", bench_columnar, 0 },
+    { "exact", bench_exact, 0 },
+    { "arrays", bench_arrays, 0 },
+    { "prom", bench_prom, 0 },
+    { "large", bench_large, 1 },   /* needs ~2.2 GiB RAM: run by name only */
+};
+
+int main(int argc, char** argv){
+    size_t nb = sizeof(g_benches)/sizeof(g_benches[0]);
+    for(size_t i=0;i<nb;i++){
+        int run = argc<2 && !g_benches[i].heavy;
+        for(int a=1;a<argc;a++) if(strcmp(argv[a], g_benches[i].name)==0) run=1;
+        if(run) g_benches[i].fn();
+    }
+    return 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file arc_main.c
+ * @brief CLI for BEJ payload archives: append, list, extract, decode and scan.
+ *
+ * Usage:
+ *   bej_arc append  <archive> -s <schema.bin> -r <resource> [-t <ms>] <data.bej>...
+ *   bej_arc list    <archive>
+ *   bej_arc extract <archive> <index> <out.bej>
+ *   bej_arc decode  <archive> -s <schema.bin>... [filters] [-c <MiB>] -o <out.json>
+ *   bej_arc scan    <archive> -s <schema.bin>... [filters] -w <path><op><value>
+ * Filters: -r <resource>  -f <from ms>  -u <until ms> (inclusive).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bej.h"
+#include "cli_args.h"
+
+/* 64-bit file positioning (long is 32 bits on Windows) */
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+/* Simple file loader */
+static int load_file(const char* path, uint8_t** out, size_t* out_n){
+    *out=NULL; *out_n=0; FILE* f=fopen(path,"rb"); if(!f) return 0;
+    fseek64(f,0,SEEK_END); long long sz=(long long)ftell64(f); fseek64(f,0,SEEK_SET);
+    if(sz<=0 || (unsigned long long)sz>SIZE_MAX){ fclose(f); return 0; }
+    uint8_t* buf=(uint8_t*)malloc((size_t)sz);
+    if(!buf){ fclose(f); return 0; }
+    if(fread(buf,1,(size_t)sz,f)!=(size_t)sz){ free(buf); fclose(f); return 0; }
+    fclose(f); *out=buf; *out_n=(size_t)sz; return 1;
+}
+
+static void usage(const char* a0){
+    fprintf(stderr,
+        "Usage: %s append  <archive> -s <schema.bin> -r <resource> [-t <ms>] <data.bej>...\n"
+        "       %s list    <archive>\n"
+        "       %s extract <archive> <index> <out.bej>\n"
+        "       %s decode  <archive> -s <schema.bin>... [filters] [-c <MiB>] -o <out.json>\n"
+        "       %s scan    <archive> -s <schema.bin>... [filters] -w <path><op><value>\n"
+        "Filters: -r <resource>  -f <from ms>  -u <until ms>\n"
+        "Operators: = != < <= > >=  (strings and enums: = and != only)\n", a0, a0, a0, a0, a0);
+}
+
+#define MAX_DICTS 16
+
+typedef struct {
+    uint8_t* blob[MAX_DICTS];
+    bej_dict D[MAX_DICTS];
+    int      n;
+} dict_set;
+
+static int dicts_add(dict_set* ds, const char* path){
+    if(ds->n >= MAX_DICTS) return 0;
+    size_t sn;
+    if(!load_file(path, &ds->blob[ds->n], &sn)){ fprintf(stderr,"ERROR: open schema %s\n", path); return 0; }
+    if(!bej_dict_load(ds->blob[ds->n], sn, &ds->D[ds->n])){ fprintf(stderr,"ERROR: parse schema dict %s\n", path); free(ds->blob[ds->n]); return 0; }
+    ds->n++;
+    return 1;
+}
+
+static const bej_dict* dicts_find(const dict_set* ds, uint64_t id){
+    for(int i=0;i<ds->n;i++) if(ds->D[i].id==id) return &ds->D[i];
+    return NULL;
+}
+
+static void dicts_free(dict_set* ds){
+    for(int i=0;i<ds->n;i++){ bej_dict_free(&ds->D[i]); free(ds->blob[i]); }
+    ds->n=0;
+}
+
+typedef struct {
+    const char* res;
+    uint64_t    from, until;
+} arc_filter;
+
+static int filter_match(const bej_arc* A, size_t i, const arc_filter* flt){
+    const bej_arc_ent* e = &A->ent[i];
+    if(e->ts < flt->from || e->ts > flt->until) return 0;
+    if(flt->res){
+        size_t rn; const char* r = bej_arc_resource(A, i, &rn);
+        if(strlen(flt->res)!=rn || memcmp(r, flt->res, rn)!=0) return 0;
+    }
+    return 1;
+}
+
+static int cmd_append(int argc, char** argv){
+    const char* arc = argv[2]; const char* sp=NULL; const char* res=NULL;
+    uint64_t ts = (uint64_t)time(NULL) * 1000u;
+    int first = 0;
+    for(int i=3;i<argc;i++){
+        if(strcmp(argv[i],"-s")==0 && i+1<argc) sp=argv[++i];
+        else if(strcmp(argv[i],"-r")==0 && i+1<argc) res=argv[++i];
+        else if(strcmp(argv[i],"-t")==0 && i+1<argc && cli_parse_u64(argv[i+1],&ts)) i++;
+        else if(argv[i][0]=='-'){ usage(argv[0]); return 1; }
+        else { first=i; break; }
+    }
+    if(!sp||!res||!first){ usage(argv[0]); return 1; }
+
+    dict_set ds = {0};
+    if(!dicts_add(&ds, sp)) return 2;
+    bej_arc_writer W;
+    if(!bej_arc_writer_open(&W, arc)){ fprintf(stderr,"ERROR: open archive %s\n", arc); dicts_free(&ds); return 3; }
+    int rc = 0;
+    for(int i=first;i<argc && !rc;i++){
+        uint8_t* b; size_t bn;
+        if(!load_file(argv[i], &b, &bn)){ fprintf(stderr,"ERROR: open bej %s\n", argv[i]); rc=4; break; }
+        if(!bej_arc_writer_add(&W, ts, res, ds.D[0].id, b, bn)){ fprintf(stderr,"ERROR: write archive\n"); rc=5; }
+        free(b);
+    }
+    if(!bej_arc_writer_close(&W) && !rc){ fprintf(stderr,"ERROR: write archive index\n"); rc=5; }
+    dicts_free(&ds);
+    return rc;
+}
+
+static int cmd_list(int argc, char** argv){
+    if(argc!=3){ usage(argv[0]); return 1; }
+    bej_arc A;
+    if(!bej_arc_open(&A, argv[2])){ fprintf(stderr,"ERROR: open archive %s\n", argv[2]); return 3; }
+    if(A.recovered) fprintf(stderr,"warning: index missing, rebuilt from %llu record(s)\n", (unsigned long long)A.n);
+    for(size_t i=0;i<A.n;i++){
+        size_t rn; const char* r = bej_arc_resource(&A, i, &rn);
+        printf("%llu\t%llu\t%016llx\t%llu\t%.*s\n", (unsigned long long)i, (unsigned long long)A.ent[i].ts,
+               (unsigned long long)A.ent[i].dict_id, (unsigned long long)A.ent[i].payload_len, (int)rn, r);
+    }
+    bej_arc_close(&A);
+    return 0;
+}
+
+static int cmd_extract(int argc, char** argv){
+    uint64_t idx;
+    if(argc!=5 || !cli_parse_u64(argv[3],&idx)){ usage(argv[0]); return 1; }
+    bej_arc A;
+    if(!bej_arc_open(&A, argv[2])){ fprintf(stderr,"ERROR: open archive %s\n", argv[2]); return 3; }
+    size_t n; const uint8_t* p = idx < A.n ? bej_arc_payload(&A, (size_t)idx, &n) : NULL;
+    if(!p){ fprintf(stderr,"ERROR: no record %s\n", argv[3]); bej_arc_close(&A); return 4; }
+    FILE* fo=fopen(argv[4],"wb");
+    int ok = fo && fwrite(p,1,n,fo)==n;
+    if(fo && fclose(fo)!=0) ok = 0;
+    bej_arc_close(&A);
+    if(!ok){ fprintf(stderr,"ERROR: write %s\n", argv[4]); return 6; }
+    return 0;
+}
+
+/* decode and scan share option parsing */
+static int cmd_decode_scan(int argc, char** argv, int scan){
+    dict_set ds = {0};
+    arc_filter flt = { NULL, 0, UINT64_MAX };
+    const char* op=NULL; const char* where=NULL; size_t cache_mib=0;
+    for(int i=3;i<argc;i++){
+        if(strcmp(argv[i],"-s")==0 && i+1<argc){ if(!dicts_add(&ds, argv[++i])){ dicts_free(&ds); return 2; } }
+        else if(strcmp(argv[i],"-r")==0 && i+1<argc) flt.res=argv[++i];
+        else if(strcmp(argv[i],"-f")==0 && i+1<argc && cli_parse_u64(argv[i+1],&flt.from)) i++;
+        else if(strcmp(argv[i],"-u")==0 && i+1<argc && cli_parse_u64(argv[i+1],&flt.until)) i++;
+        else if(!scan && strcmp(argv[i],"-o")==0 && i+1<argc) op=argv[++i];
+        else if(!scan && strcmp(argv[i],"-c")==0 && i+1<argc && cli_parse_mib(argv[i+1],&cache_mib)) i++;
+        else if(scan && strcmp(argv[i],"-w")==0 && i+1<argc) where=argv[++i];
+        else { usage(argv[0]); dicts_free(&ds); return 1; }
+    }
+    if(!ds.n || (scan ? !where : !op)){ usage(argv[0]); dicts_free(&ds); return 1; }
+
+    /* Predicates are compiled once per dictionary */
+    bej_pred preds[MAX_DICTS]; int pred_ok[MAX_DICTS] = {0};
+    if(scan){
+        int any = 0;
+        for(int k=0;k<ds.n;k++){ pred_ok[k] = bej_pred_compile(&preds[k], &ds.D[k], where); any |= pred_ok[k]; }
+        if(!any){ fprintf(stderr,"ERROR: predicate %s does not match any dictionary\n", where); dicts_free(&ds); return 5; }
+    }
+
+    bej_arc A;
+    if(!bej_arc_open(&A, argv[2])){ fprintf(stderr,"ERROR: open archive %s\n", argv[2]); dicts_free(&ds); return 3; }
+    FILE* fo = NULL;
+    if(!scan){ fo=fopen(op,"wb"); if(!fo){ fprintf(stderr,"ERROR: open out %s\n", op); bej_arc_close(&A); dicts_free(&ds); return 6; } }
+    bej_cache* cache = cache_mib ? bej_cache_new(cache_mib << 20) : NULL;
+
+    int rc = 0; size_t hits = 0, skipped = 0;
+    for(size_t i=0;i<A.n && !rc;i++){
+        if(!filter_match(&A, i, &flt)) continue;
+        const bej_dict* D = dicts_find(&ds, A.ent[i].dict_id);
+        if(!D){ skipped++; continue; }
+        size_t n; const uint8_t* p = bej_arc_payload(&A, i, &n);
+        if(scan){
+            int k = (int)(D - ds.D);
+            int m = pred_ok[k] ? bej_pred_eval(&preds[k], p, n) : 0;
+            if(m < 0){ fprintf(stderr,"ERROR: malformed record %llu\n", (unsigned long long)i); rc=7; break; }
+            if(m){
+                size_t rn; const char* r = bej_arc_resource(&A, i, &rn);
+                printf("%llu\t%llu\t%.*s\n", (unsigned long long)i, (unsigned long long)A.ent[i].ts, (int)rn, r);
+                hits++;
+            }
+        }else{
+            int ok = cache ? bej_cache_decode_to_json(cache, fo, p, n, D) : bej_decode_to_json(fo, p, n, D);
+            if(!ok){ fprintf(stderr,"ERROR: decode record %llu\n", (unsigned long long)i); rc=7; }
+        }
+    }
+    if(skipped) fprintf(stderr,"warning: %llu record(s) use a dictionary that was not given\n", (unsigned long long)skipped);
+    if(scan) fprintf(stderr,"%llu matching record(s)\n", (unsigned long long)hits);
+    if(fo) fclose(fo);
+    if(rc && fo) remove(op);
+    bej_cache_free(cache);
+    bej_arc_close(&A);
+    dicts_free(&ds);
+    return rc;
+}
+
+int main(int argc, char** argv){
+    if(argc<3){ usage(argv[0]); return 1; }
+    if(strcmp(argv[1],"append")==0)  return cmd_append(argc, argv);
+    if(strcmp(argv[1],"list")==0)    return cmd_list(argc, argv);
+    if(strcmp(argv[1],"extract")==0) return cmd_extract(argc, argv);
+    if(strcmp(argv[1],"decode")==0)  return cmd_decode_scan(argc, argv, 0);
+    if(strcmp(argv[1],"scan")==0)    return cmd_decode_scan(argc, argv, 1);
+    usage(argv[0]);
+    return 1;
+}
@@ -17,19 +17,40 @@ typedef struct bej_jsonw bej_jsonw;
 typedef struct {
     uint8_t  fmt;       /**< bejTupleF (upper nibble conveys value format in tuples). */
     uint16_t seq;       /**< SequenceNumber within its cluster. */
-    uint16_t child_off; /**< Absolute byte offset (from file start) to child cluster records. */
+    uint32_t child_off; /**< Absolute byte offset (from file start) to child cluster records. */
     uint16_t child_cnt; /**< Number of child entries in that cluster. */
     uint8_t  name_len;  /**< Length of the UTF-8 name including NUL terminator. */
-    uint16_t name_off;  /**< Absolute byte offset (from file start) of the UTF-8 name. */
+    uint32_t name_off;  /**< Absolute byte offset (from file start) of the UTF-8 name. */
+    const char* key;    /**< Pre-rendered JSON key `"Name": ` (`"seq_N": ` if unnamed); NULL if not rendered. */
+    size_t   key_n;
+    const char* str;    /**< Pre-rendered JSON string `"Name"` (enum option value); NULL if unnamed. */
+    size_t   str_n;
 } bej_dict_entry;
 
+/**
+ * @name Dictionary header flags
+ * Table 31 entries carry 16-bit offsets, which caps a dictionary at 64 KiB.
+ * As a local extension (not DSP0218: the bit is reserved there), dictionaries
+ * with @ref BEJ_DICT_FLAG_LOCAL_WIDE set use 14-byte entries with 32-bit
+ * ChildPointerOffset and NameOffset fields instead:
+ * `fmt(1) seq(2) child_off(4) child_cnt(2) name_len(1) name_off(4)`.
+ * Only bej_dict_load_local() accepts them; bej_dict_load() rejects the bit.
+ * @{ */
+#define BEJ_DICT_FLAG_LOCAL_WIDE 0x80
+#define BEJ_DICT_ENTRY_N     10   /**< Table 31 entry size. */
+#define BEJ_DICT_WIDE_ENTRY_N 14  /**< Wide entry size. */
+/** @} */
+
 typedef struct {
     bej_dict_entry* ent;   /**< Pointer to array of entries. */
     size_t          n;     /**< Number of entries. */
+    size_t          ent_size;    /**< On-disk entry size (@ref BEJ_DICT_ENTRY_N or @ref BEJ_DICT_WIDE_ENTRY_N). */
     size_t          entries_ofs; /**< Absolute file offset where entries array begins. */
     size_t          names_ofs;   /**< Absolute file offset where the names pool begins. */
     const uint8_t*  blob;  /**< Raw dictionary blob (for name access). */
     size_t          blob_n;/**< Size of blob in bytes. */
+    uint64_t        id;    /**< Content hash of the blob (dictionary identity for caches). */
+    char*           render;/**< Pool holding the entries' pre-rendered key/str bytes. */
 } bej_dict;
 
 typedef struct {
@@ -47,42 +68,255 @@ typedef struct {
 /** @} */
 
 /* Reader API */
-struct bej_br {
+
+/** One input segment of a scatter-gather list. */
+typedef struct {
     const uint8_t* d;
-    size_t n;
-    size_t p;
+    size_t         n;
+} bej_iov;
+
+/**
+ * Byte reader. @c d / @c n / @c p describe the current segment; a reader
+ * made with bej_br_init() has a single segment covering the whole buffer.
+ */
+struct bej_br {
+    const uint8_t* d;     /**< Current segment. */
+    size_t n;             /**< Size of the current segment. */
+    size_t p;             /**< Position within the current segment. */
+    const bej_iov* seg;   /**< Segment list (NULL for a contiguous buffer). */
+    size_t nseg;          /**< Number of segments. */
+    size_t si;            /**< Index of the current segment. */
+    size_t base;          /**< Absolute offset of the current segment. */
+    size_t total;         /**< Total size over all segments. */
 };
 void     bej_br_init(bej_br* b, const uint8_t* d, size_t n);
+void     bej_br_init_iov(bej_br* b, const bej_iov* seg, size_t nseg);
+size_t   bej_br_chunk(bej_br* b, const uint8_t** ptr);
 int      bej_br_u8(bej_br* b, uint8_t* v);
 int      bej_br_get(bej_br* b, uint8_t* dst, size_t k);
 int      bej_br_seek(bej_br* b, size_t pos);
-int      bej_br_left(const bej_br* b);
+int      bej_br_skip(bej_br* b, uint64_t L);
+size_t   bej_br_left(const bej_br* b);
 int      bej_read_nnint(bej_br* b, uint64_t* out);
 
 /* JSON writer API */
 struct bej_jsonw {
-    FILE* f;
+    FILE* f;          /**< File sink, or NULL when rendering into @ref buf. */
     int   ind;
     int   need_comma;
+    char*  buf;       /**< Memory sink (heap, grown on demand). */
+    size_t len;       /**< Bytes used in @ref buf. */
+    size_t cap;       /**< Bytes allocated for @ref buf. */
+    int    oom;       /**< Set if the memory sink failed to grow. */
+    int    sink;      /**< Memory sink mode (@ref BEJ_JW_GROW, @ref BEJ_JW_COUNT, @ref BEJ_JW_FIXED). */
 };
+
+/** @name Memory sink modes (@ref bej_jsonw::sink, ignored for FILE sinks) @{ */
+#define BEJ_JW_GROW   0   /**< Heap buffer grown on demand. */
+#define BEJ_JW_COUNT  1   /**< Nothing is stored; only @ref bej_jsonw::len advances. */
+#define BEJ_JW_FIXED  2   /**< Exactly sized buffer, written without bounds checks (exact-size decode only). */
+/** @} */
+
 void bej_jw_init(bej_jsonw* j, FILE* f);
+void bej_jw_init_mem(bej_jsonw* j);
+void bej_jw_init_count(bej_jsonw* j);
+void bej_jw_write(bej_jsonw* j, const char* s, size_t n);
+void bej_jw_raw(bej_jsonw* j, const char* s);
 void bej_jw_nl(bej_jsonw* j);
 void bej_jw_begin_obj(bej_jsonw* j);
 void bej_jw_end_obj(bej_jsonw* j);
 void bej_jw_begin_arr(bej_jsonw* j);
 void bej_jw_end_arr(bej_jsonw* j);
 void bej_jw_key(bej_jsonw* j, const char* k);
+void bej_jw_key_lit(bej_jsonw* j, const char* qk, size_t n);
 void bej_jw_str(bej_jsonw* j, const char* s);
+void bej_jw_strn(bej_jsonw* j, const char* s, size_t n);
+size_t bej_jw_esc(bej_jsonw* j, const char* s, size_t n);
 void bej_jw_int(bej_jsonw* j, long long v);
 
 /* Dictionary API */
 int  bej_dict_load(const uint8_t* d, size_t n, bej_dict* out);
+int  bej_dict_load_local(const uint8_t* d, size_t n, bej_dict* out);
 void bej_dict_free(bej_dict* D);
-const char* bej_dict_name_at(const bej_dict* D, uint16_t name_off);
-const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint16_t seq);
+const char* bej_dict_name_at(const bej_dict* D, uint32_t name_off);
+const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint64_t seq);
+bej_cluster bej_dict_child_cluster(const bej_dict* D, const bej_dict_entry* de);
 
 /* Decoder API */
 int  bej_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_to_mem(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n);
+int  bej_decode_iov_to_jsonw(bej_jsonw* jw, const bej_iov* seg, size_t nseg, const bej_dict* D);
+int  bej_decode_iov_to_json(FILE* out, const bej_iov* seg, size_t nseg, const bej_dict* D);
+int  bej_decode_size(const uint8_t* bej, size_t bej_n, const bej_dict* D, size_t* out_n);
+int  bej_decode_to_mem_exact(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n);
+int  bej_decode_to_path_exact(const char* path, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_value(bej_jsonw* jw, bej_br* br, const bej_dict* D, const bej_dict_entry* de, uint8_t fmt, uint64_t L);
+
+/** @name Delta output formats for bej_delta_to_json() @{ */
+#define BEJ_PATCH_MERGE 0   /**< JSON Merge Patch (RFC 7386). */
+#define BEJ_PATCH_JSON  1   /**< JSON Patch (RFC 6902). */
+/** @} */
+
+/* Decoded-output cache API */
+typedef struct bej_cache bej_cache;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t   entries;   /**< Entries currently cached. */
+    size_t   bytes;     /**< Memory accounted against the limit. */
+} bej_cache_stats;
+
+uint64_t   bej_hash64(const void* data, size_t n, uint64_t seed);
+bej_cache* bej_cache_new(size_t mem_limit);
+void       bej_cache_free(bej_cache* c);
+int        bej_cache_decode(bej_cache* c, const uint8_t* bej, size_t bej_n, const bej_dict* D,
+                            const char** out, size_t* out_n);
+int        bej_cache_decode_to_json(bej_cache* c, FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+void       bej_cache_get_stats(const bej_cache* c, bej_cache_stats* st);
+
+/* OpenMetrics exporter API (mapped properties -> samples, no JSON stage) */
+#define BEJ_PROM_MAX_DEPTH 8   /**< Longest mapped property path, in Set levels. */
+
+typedef struct bej_prom bej_prom;
+
+bej_prom* bej_prom_new(const bej_dict* D, const char* map, size_t map_n, size_t* err_line);
+void      bej_prom_free(bej_prom* P);
+int       bej_prom_add(bej_prom* P, const uint8_t* bej, size_t bej_n, const char* labels);
+int       bej_prom_write(bej_prom* P, FILE* out);
+size_t    bej_prom_pending(const bej_prom* P);
+
+/* Hot-reloadable dictionary API (lock-free readers, epoch-based reclamation) */
+typedef struct bej_dict_slot bej_dict_slot;
+typedef struct bej_dict_ref  bej_dict_ref;
+
+typedef struct {
+    uint64_t publishes;   /**< Dictionaries published so far. */
+    uint64_t freed;       /**< Replaced dictionaries reclaimed. */
+    size_t   pending;     /**< Replaced dictionaries still waiting for readers. */
+    size_t   readers;     /**< Registered reader threads. */
+} bej_dict_slot_stats;
+
+bej_dict_slot*  bej_dict_slot_new(size_t max_readers);
+void            bej_dict_slot_free(bej_dict_slot* s);
+int             bej_dict_slot_publish(bej_dict_slot* s, const uint8_t* d, size_t n);
+size_t          bej_dict_slot_reclaim(bej_dict_slot* s);
+int             bej_dict_slot_register(bej_dict_slot* s);
+void            bej_dict_slot_unregister(bej_dict_slot* s, int r);
+const bej_dict* bej_dict_slot_enter(bej_dict_slot* s, int r);
+void            bej_dict_slot_leave(bej_dict_slot* s, int r);
+bej_dict_ref*   bej_dict_slot_acquire(bej_dict_slot* s, int r);
+const bej_dict* bej_dict_ref_get(const bej_dict_ref* h);
+void            bej_dict_ref_release(bej_dict_ref* h);
+int             bej_dict_slot_decode_to_jsonw(bej_dict_slot* s, int r, bej_jsonw* jw, const uint8_t* bej, size_t bej_n);
+void            bej_dict_slot_get_stats(bej_dict_slot* s, bej_dict_slot_stats* st);
+
+/* Predicate API (evaluated on raw payloads, skipping unrelated subtrees) */
+#define BEJ_PRED_MAX_DEPTH 16
+
+/** @name Predicate operators @{ */
+#define BEJ_PRED_EQ 0
+#define BEJ_PRED_NE 1
+#define BEJ_PRED_LT 2
+#define BEJ_PRED_LE 3
+#define BEJ_PRED_GT 4
+#define BEJ_PRED_GE 5
+/** @} */
+
+typedef struct {
+    uint16_t    seq[BEJ_PRED_MAX_DEPTH]; /**< Sequence numbers along the property path. */
+    unsigned    depth;                   /**< Number of path components. */
+    uint8_t     fmt;                     /**< Expected value format of the leaf. */
+    int         op;                      /**< One of BEJ_PRED_*. */
+    long long   ival;                    /**< Integer operand, or enum ordinal. */
+    const char* sval;                    /**< String operand (points into the expression). */
+    size_t      sval_n;
+} bej_pred;
+
+const bej_dict_entry* bej_cluster_lookup_name(const bej_dict* D, bej_cluster c, const char* name, size_t name_n);
+int  bej_pred_compile(bej_pred* P, const bej_dict* D, const char* expr);
+int  bej_pred_eval(const bej_pred* P, const uint8_t* bej, size_t bej_n);
+
+/* Archive API */
+typedef struct {
+    uint64_t rec_off;      /**< Offset of the record header. */
+    uint64_t ts;           /**< Timestamp (Unix milliseconds in the CLI). */
+    uint64_t dict_id;      /**< @ref bej_dict::id of the payload's dictionary. */
+    uint64_t payload_off;  /**< Offset of the BEJ payload. */
+    uint64_t payload_len;
+    uint64_t res_off;      /**< Offset of the resource id bytes (@ref rec_off + record header). */
+    uint16_t res_len;
+} bej_arc_ent;
+
+typedef struct {
+    const uint8_t* base;   /**< Mapped archive file. */
+    size_t         size;
+    int            mapped; /**< 1 if @ref base is an mmap, 0 if heap. */
+    bej_arc_ent*   ent;    /**< Index (one entry per record, in append order). */
+    size_t         n;
+    uint64_t       data_end;  /**< End of the last record. */
+    int            recovered; /**< 1 if the index was rebuilt by scanning. */
+} bej_arc;
+
+typedef struct {
+    FILE*        f;
+    bej_arc_ent* ent;
+    size_t       n;
+    size_t       cap;
+    uint64_t     pos;      /**< Where the next record goes. */
+} bej_arc_writer;
+
+int  bej_arc_open(bej_arc* A, const char* path);
+void bej_arc_close(bej_arc* A);
+const uint8_t* bej_arc_payload(const bej_arc* A, size_t i, size_t* n);
+const char*    bej_arc_resource(const bej_arc* A, size_t i, size_t* n);
+int  bej_arc_writer_open(bej_arc_writer* W, const char* path);
+int  bej_arc_writer_add(bej_arc_writer* W, uint64_t ts, const char* resource, uint64_t dict_id,
+                        const uint8_t* bej, size_t bej_n);
+int  bej_arc_writer_close(bej_arc_writer* W);
+
+/* Delta API */
+int  bej_delta_to_json(FILE* out, const uint8_t* prev, size_t prev_n,
+                       const uint8_t* cur, size_t cur_n, const bej_dict* D, int mode);
+
+/* Columnar API (batch of payloads -> one typed column per property path) */
+#define BEJ_COL_MAGIC     "BEJC"
+#define BEJ_COL_VERSION   1
+#define BEJ_COL_MAX_DEPTH 8     /**< Set nesting followed when deriving columns. */
+#define BEJ_COL_MAX_PATH  512   /**< Longest column path, including the terminator. */
+
+typedef struct {
+    char*        path;     /**< Property path, components separated by '/'. */
+    uint8_t      fmt;      /**< BEJ_FMT_INT, BEJ_FMT_STRING or BEJ_FMT_ENUM. */
+    uint8_t*     valid;    /**< Validity bitmap: bit r (LSB first) is set if row r has a value. */
+    int64_t*     i64;      /**< Int: one value per row. */
+    uint32_t*    idx;      /**< Enum: per row, index (ordinal) into @ref opts. */
+    uint64_t*    off;      /**< String: rows+1 offsets into @ref data. */
+    char*        data;     /**< String: concatenated UTF-8 values. */
+    size_t       data_n, data_cap;
+    const char** opts;     /**< Enum: option names by ordinal (NULL where undefined); point into the dictionary. */
+    uint32_t     nopts;
+} bej_col;
+
+typedef struct bej_col_node bej_col_node;
+
+typedef struct {
+    const bej_dict* D;
+    bej_col*        col;   /**< Columns, in dictionary order. */
+    size_t          ncol;
+    bej_col_node*   node;  /**< Per-Set routing tables (internal). */
+    size_t          nnode;
+    size_t          rows;  /**< Rows (payloads) added so far. */
+    size_t          cap;
+} bej_colset;
+
+int  bej_colset_init(bej_colset* C, const bej_dict* D);
+void bej_colset_free(bej_colset* C);
+const bej_col* bej_colset_find(const bej_colset* C, const char* path);
+int  bej_colset_add(bej_colset* C, const uint8_t* bej, size_t bej_n);
+int  bej_colset_write(const bej_colset* C, FILE* out);
 
 #endif /* BEJ_H_ */
 #ifndef BEJ_H_
@@ -104,19 +338,40 @@ typedef struct bej_jsonw bej_jsonw;
 typedef struct {
     uint8_t  fmt;       /**< bejTupleF (upper nibble conveys value format in tuples). */
     uint16_t seq;       /**< SequenceNumber within its cluster. */
-    uint16_t child_off; /**< Absolute byte offset (from file start) to child cluster records. */
+    uint32_t child_off; /**< Absolute byte offset (from file start) to child cluster records. */
     uint16_t child_cnt; /**< Number of child entries in that cluster. */
     uint8_t  name_len;  /**< Length of the UTF-8 name including NUL terminator. */
-    uint16_t name_off;  /**< Absolute byte offset (from file start) of the UTF-8 name. */
+    uint32_t name_off;  /**< Absolute byte offset (from file start) of the UTF-8 name. */
+    const char* key;    /**< Pre-rendered JSON key `"Name": ` (`"seq_N": ` if unnamed); NULL if not rendered. */
+    size_t   key_n;
+    const char* str;    /**< Pre-rendered JSON string `"Name"` (enum option value); NULL if unnamed. */
+    size_t   str_n;
 } bej_dict_entry;
 
+/**
+ * @name Dictionary header flags
+ * Table 31 entries carry 16-bit offsets, which caps a dictionary at 64 KiB.
+ * As a local extension (not DSP0218: the bit is reserved there), dictionaries
+ * with @ref BEJ_DICT_FLAG_LOCAL_WIDE set use 14-byte entries with 32-bit
+ * ChildPointerOffset and NameOffset fields instead:
+ * `fmt(1) seq(2) child_off(4) child_cnt(2) name_len(1) name_off(4)`.
+ * Only bej_dict_load_local() accepts them; bej_dict_load() rejects the bit.
+ * @{ */
+#define BEJ_DICT_FLAG_LOCAL_WIDE 0x80
+#define BEJ_DICT_ENTRY_N     10   /**< Table 31 entry size. */
+#define BEJ_DICT_WIDE_ENTRY_N 14  /**< Wide entry size. */
+/** @} */
+
 typedef struct {
     bej_dict_entry* ent;   /**< Pointer to array of entries. */
     size_t          n;     /**< Number of entries. */
+    size_t          ent_size;    /**< On-disk entry size (@ref BEJ_DICT_ENTRY_N or @ref BEJ_DICT_WIDE_ENTRY_N). */
     size_t          entries_ofs; /**< Absolute file offset where entries array begins. */
     size_t          names_ofs;   /**< Absolute file offset where the names pool begins. */
     const uint8_t*  blob;  /**< Raw dictionary blob (for name access). */
     size_t          blob_n;/**< Size of blob in bytes. */
+    uint64_t        id;    /**< Content hash of the blob (dictionary identity for caches). */
+    char*           render;/**< Pool holding the entries' pre-rendered key/str bytes. */
 } bej_dict;
 
 typedef struct {
@@ -134,41 +389,254 @@ typedef struct {
 /** @} */
 
 /* Reader API */
-struct bej_br {
+
+/** One input segment of a scatter-gather list. */
+typedef struct {
     const uint8_t* d;
-    size_t n;
-    size_t p;
+    size_t         n;
+} bej_iov;
+
+/**
+ * Byte reader. @c d / @c n / @c p describe the current segment; a reader
+ * made with bej_br_init() has a single segment covering the whole buffer.
+ */
+struct bej_br {
+    const uint8_t* d;     /**< Current segment. */
+    size_t n;             /**< Size of the current segment. */
+    size_t p;             /**< Position within the current segment. */
+    const bej_iov* seg;   /**< Segment list (NULL for a contiguous buffer). */
+    size_t nseg;          /**< Number of segments. */
+    size_t si;            /**< Index of the current segment. */
+    size_t base;          /**< Absolute offset of the current segment. */
+    size_t total;         /**< Total size over all segments. */
 };
 void     bej_br_init(bej_br* b, const uint8_t* d, size_t n);
+void     bej_br_init_iov(bej_br* b, const bej_iov* seg, size_t nseg);
+size_t   bej_br_chunk(bej_br* b, const uint8_t** ptr);
 int      bej_br_u8(bej_br* b, uint8_t* v);
 int      bej_br_get(bej_br* b, uint8_t* dst, size_t k);
 int      bej_br_seek(bej_br* b, size_t pos);
-int      bej_br_left(const bej_br* b);
+int      bej_br_skip(bej_br* b, uint64_t L);
+size_t   bej_br_left(const bej_br* b);
 int      bej_read_nnint(bej_br* b, uint64_t* out);
 
 /* JSON writer API */
 struct bej_jsonw {
-    FILE* f;
+    FILE* f;          /**< File sink, or NULL when rendering into @ref buf. */
     int   ind;
     int   need_comma;
+    char*  buf;       /**< Memory sink (heap, grown on demand). */
+    size_t len;       /**< Bytes used in @ref buf. */
+    size_t cap;       /**< Bytes allocated for @ref buf. */
+    int    oom;       /**< Set if the memory sink failed to grow. */
+    int    sink;      /**< Memory sink mode (@ref BEJ_JW_GROW, @ref BEJ_JW_COUNT, @ref BEJ_JW_FIXED). */
 };
+
+/** @name Memory sink modes (@ref bej_jsonw::sink, ignored for FILE sinks) @{ */
+#define BEJ_JW_GROW   0   /**< Heap buffer grown on demand. */
+#define BEJ_JW_COUNT  1   /**< Nothing is stored; only @ref bej_jsonw::len advances. */
+#define BEJ_JW_FIXED  2   /**< Exactly sized buffer, written without bounds checks (exact-size decode only). */
+/** @} */
+
 void bej_jw_init(bej_jsonw* j, FILE* f);
+void bej_jw_init_mem(bej_jsonw* j);
+void bej_jw_init_count(bej_jsonw* j);
+void bej_jw_write(bej_jsonw* j, const char* s, size_t n);
+void bej_jw_raw(bej_jsonw* j, const char* s);
 void bej_jw_nl(bej_jsonw* j);
 void bej_jw_begin_obj(bej_jsonw* j);
 void bej_jw_end_obj(bej_jsonw* j);
 void bej_jw_begin_arr(bej_jsonw* j);
 void bej_jw_end_arr(bej_jsonw* j);
 void bej_jw_key(bej_jsonw* j, const char* k);
+void bej_jw_key_lit(bej_jsonw* j, const char* qk, size_t n);
 void bej_jw_str(bej_jsonw* j, const char* s);
+void bej_jw_strn(bej_jsonw* j, const char* s, size_t n);
+size_t bej_jw_esc(bej_jsonw* j, const char* s, size_t n);
 void bej_jw_int(bej_jsonw* j, long long v);
 
 /* Dictionary API */
 int  bej_dict_load(const uint8_t* d, size_t n, bej_dict* out);
+int  bej_dict_load_local(const uint8_t* d, size_t n, bej_dict* out);
 void bej_dict_free(bej_dict* D);
-const char* bej_dict_name_at(const bej_dict* D, uint16_t name_off);
-const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint16_t seq);
+const char* bej_dict_name_at(const bej_dict* D, uint32_t name_off);
+const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint64_t seq);
+bej_cluster bej_dict_child_cluster(const bej_dict* D, const bej_dict_entry* de);
 
 /* Decoder API */
 int  bej_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_to_mem(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n);
+int  bej_decode_iov_to_jsonw(bej_jsonw* jw, const bej_iov* seg, size_t nseg, const bej_dict* D);
+int  bej_decode_iov_to_json(FILE* out, const bej_iov* seg, size_t nseg, const bej_dict* D);
+int  bej_decode_size(const uint8_t* bej, size_t bej_n, const bej_dict* D, size_t* out_n);
+int  bej_decode_to_mem_exact(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n);
+int  bej_decode_to_path_exact(const char* path, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+int  bej_decode_value(bej_jsonw* jw, bej_br* br, const bej_dict* D, const bej_dict_entry* de, uint8_t fmt, uint64_t L);
+
+/** @name Delta output formats for bej_delta_to_json() @{ */
+#define BEJ_PATCH_MERGE 0   /**< JSON Merge Patch (RFC 7386). */
+#define BEJ_PATCH_JSON  1   /**< JSON Patch (RFC 6902). */
+/** @} */
+
+/* Decoded-output cache API */
+typedef struct bej_cache bej_cache;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t   entries;   /**< Entries currently cached. */
+    size_t   bytes;     /**< Memory accounted against the limit. */
+} bej_cache_stats;
+
+uint64_t   bej_hash64(const void* data, size_t n, uint64_t seed);
+bej_cache* bej_cache_new(size_t mem_limit);
+void       bej_cache_free(bej_cache* c);
+int        bej_cache_decode(bej_cache* c, const uint8_t* bej, size_t bej_n, const bej_dict* D,
+                            const char** out, size_t* out_n);
+int        bej_cache_decode_to_json(bej_cache* c, FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D);
+void       bej_cache_get_stats(const bej_cache* c, bej_cache_stats* st);
+
+/* OpenMetrics exporter API (mapped properties -> samples, no JSON stage) */
+#define BEJ_PROM_MAX_DEPTH 8   /**< Longest mapped property path, in Set levels. */
+
+typedef struct bej_prom bej_prom;
+
+bej_prom* bej_prom_new(const bej_dict* D, const char* map, size_t map_n, size_t* err_line);
+void      bej_prom_free(bej_prom* P);
+int       bej_prom_add(bej_prom* P, const uint8_t* bej, size_t bej_n, const char* labels);
+int       bej_prom_write(bej_prom* P, FILE* out);
+size_t    bej_prom_pending(const bej_prom* P);
+
+/* Hot-reloadable dictionary API (lock-free readers, epoch-based reclamation) */
+typedef struct bej_dict_slot bej_dict_slot;
+typedef struct bej_dict_ref  bej_dict_ref;
+
+typedef struct {
+    uint64_t publishes;   /**< Dictionaries published so far. */
+    uint64_t freed;       /**< Replaced dictionaries reclaimed. */
+    size_t   pending;     /**< Replaced dictionaries still waiting for readers. */
+    size_t   readers;     /**< Registered reader threads. */
+} bej_dict_slot_stats;
+
+bej_dict_slot*  bej_dict_slot_new(size_t max_readers);
+void            bej_dict_slot_free(bej_dict_slot* s);
+int             bej_dict_slot_publish(bej_dict_slot* s, const uint8_t* d, size_t n);
+size_t          bej_dict_slot_reclaim(bej_dict_slot* s);
+int             bej_dict_slot_register(bej_dict_slot* s);
+void            bej_dict_slot_unregister(bej_dict_slot* s, int r);
+const bej_dict* bej_dict_slot_enter(bej_dict_slot* s, int r);
+void            bej_dict_slot_leave(bej_dict_slot* s, int r);
+bej_dict_ref*   bej_dict_slot_acquire(bej_dict_slot* s, int r);
+const bej_dict* bej_dict_ref_get(const bej_dict_ref* h);
+void            bej_dict_ref_release(bej_dict_ref* h);
+int             bej_dict_slot_decode_to_jsonw(bej_dict_slot* s, int r, bej_jsonw* jw, const uint8_t* bej, size_t bej_n);
+void            bej_dict_slot_get_stats(bej_dict_slot* s, bej_dict_slot_stats* st);
+
+/* Predicate API (evaluated on raw payloads, skipping unrelated subtrees) */
+#define BEJ_PRED_MAX_DEPTH 16
+
+/** @name Predicate operators @{ */
+#define BEJ_PRED_EQ 0
+#define BEJ_PRED_NE 1
+#define BEJ_PRED_LT 2
+#define BEJ_PRED_LE 3
+#define BEJ_PRED_GT 4
+#define BEJ_PRED_GE 5
+/** @} */
+
+typedef struct {
+    uint16_t    seq[BEJ_PRED_MAX_DEPTH]; /**< Sequence numbers along the property path. */
+    unsigned    depth;                   /**< Number of path components. */
+    uint8_t     fmt;                     /**< Expected value format of the leaf. */
+    int         op;                      /**< One of BEJ_PRED_*. */
+    long long   ival;                    /**< Integer operand, or enum ordinal. */
+    const char* sval;                    /**< String operand (points into the expression). */
+    size_t      sval_n;
+} bej_pred;
+
+const bej_dict_entry* bej_cluster_lookup_name(const bej_dict* D, bej_cluster c, const char* name, size_t name_n);
+int  bej_pred_compile(bej_pred* P, const bej_dict* D, const char* expr);
+int  bej_pred_eval(const bej_pred* P, const uint8_t* bej, size_t bej_n);
+
+/* Archive API */
+typedef struct {
+    uint64_t rec_off;      /**< Offset of the record header. */
+    uint64_t ts;           /**< Timestamp (Unix milliseconds in the CLI). */
+    uint64_t dict_id;      /**< @ref bej_dict::id of the payload's dictionary. */
+    uint64_t payload_off;  /**< Offset of the BEJ payload. */
+    uint64_t payload_len;
+    uint64_t res_off;      /**< Offset of the resource id bytes (@ref rec_off + record header). */
+    uint16_t res_len;
+} bej_arc_ent;
+
+typedef struct {
+    const uint8_t* base;   /**< Mapped archive file. */
+    size_t         size;
+    int            mapped; /**< 1 if @ref base is an mmap, 0 if heap. */
+    bej_arc_ent*   ent;    /**< Index (one entry per record, in append order). */
+    size_t         n;
+    uint64_t       data_end;  /**< End of the last record. */
+    int            recovered; /**< 1 if the index was rebuilt by scanning. */
+} bej_arc;
+
+typedef struct {
+    FILE*        f;
+    bej_arc_ent* ent;
+    size_t       n;
+    size_t       cap;
+    uint64_t     pos;      /**< Where the next record goes. */
+} bej_arc_writer;
+
+int  bej_arc_open(bej_arc* A, const char* path);
+void bej_arc_close(bej_arc* A);
+const uint8_t* bej_arc_payload(const bej_arc* A, size_t i, size_t* n);
+const char*    bej_arc_resource(const bej_arc* A, size_t i, size_t* n);
+int  bej_arc_writer_open(bej_arc_writer* W, const char* path);
+int  bej_arc_writer_add(bej_arc_writer* W, uint64_t ts, const char* resource, uint64_t dict_id,
+                        const uint8_t* bej, size_t bej_n);
+int  bej_arc_writer_close(bej_arc_writer* W);
+
+/* Delta API */
+int  bej_delta_to_json(FILE* out, const uint8_t* prev, size_t prev_n,
+                       const uint8_t* cur, size_t cur_n, const bej_dict* D, int mode);
+
+/* Columnar API (batch of payloads -> one typed column per property path) */
+#define BEJ_COL_MAGIC     "BEJC"
+#define BEJ_COL_VERSION   1
+#define BEJ_COL_MAX_DEPTH 8     /**< Set nesting followed when deriving columns. */
+#define BEJ_COL_MAX_PATH  512   /**< Longest column path, including the terminator. */
+
+typedef struct {
+    char*        path;     /**< Property path, components separated by '/'. */
+    uint8_t      fmt;      /**< BEJ_FMT_INT, BEJ_FMT_STRING or BEJ_FMT_ENUM. */
+    uint8_t*     valid;    /**< Validity bitmap: bit r (LSB first) is set if row r has a value. */
+    int64_t*     i64;      /**< Int: one value per row. */
+    uint32_t*    idx;      /**< Enum: per row, index (ordinal) into @ref opts. */
+    uint64_t*    off;      /**< String: rows+1 offsets into @ref data. */
+    char*        data;     /**< String: concatenated UTF-8 values. */
+    size_t       data_n, data_cap;
+    const char** opts;     /**< Enum: option names by ordinal (NULL where undefined); point into the dictionary. */
+    uint32_t     nopts;
+} bej_col;
+
+typedef struct bej_col_node bej_col_node;
+
+typedef struct {
+    const bej_dict* D;
+    bej_col*        col;   /**< Columns, in dictionary order. */
+    size_t          ncol;
+    bej_col_node*   node;  /**< Per-Set routing tables (internal). */
+    size_t          nnode;
+    size_t          rows;  /**< Rows (payloads) added so far. */
+    size_t          cap;
+} bej_colset;
+
+int  bej_colset_init(bej_colset* C, const bej_dict* D);
+void bej_colset_free(bej_colset* C);
+const bej_col* bej_colset_find(const bej_colset* C, const char* path);
+int  bej_colset_add(bej_colset* C, const uint8_t* bej, size_t bej_n);
+int  bej_colset_write(const bej_colset* C, FILE* out);
 
 #endif /* BEJ_H_ */
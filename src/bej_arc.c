@@ -0,0 +1,310 @@
+/**
+ * @file bej_arc.c
+ * @brief Append-only archive of raw BEJ payloads with a footer index.
+ *
+ * Layout (all integers little-endian):
+ *
+ *     header   "BEJA" u16 version u16 reserved
+ *     record*  "BREC" u64 ts u64 dict_id u64 payload_len u16 res_len u32 0
+ *              res[res_len] payload[payload_len]
+ *     index    count * { u64 rec_off u64 ts u64 dict_id u64 payload_off
+ *                        u64 payload_len u32 0 u16 res_len u16 0 }
+ *     trailer  u64 index_off u64 count u32 version "BEJI"
+ *
+ * The resource id directly follows its record header, so its offset is
+ * derived from rec_off rather than stored (the u32 field is reserved; older
+ * writers stored the same value there).
+ *
+ * Readers map the file and use the index; payloads are never copied. Appending
+ * overwrites the old index with new records and writes a fresh index. Records
+ * are self-describing, so an archive whose index was lost (e.g. a crash
+ * while appending) is recovered by scanning the records.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "bej.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define ARC_VERSION   1u
+#define ARC_HDR_N     8u
+#define ARC_REC_N     34u   /* record header without resource id */
+#define ARC_IDX_N     48u
+#define ARC_TRAILER_N 24u
+
+/* 64-bit file positioning (long is 32 bits on Windows) */
+#ifdef _WIN32
+#define arc_fseek(f,o) _fseeki64((f), (long long)(o), SEEK_SET)
+#define arc_ftell(f)   _ftelli64(f)
+#else
+#define arc_fseek(f,o) fseeko((f), (off_t)(o), SEEK_SET)
+#define arc_ftell(f)   ftello(f)
+#endif
+
+static uint16_t rd16(const uint8_t* p){ return (uint16_t)(p[0] | (p[1]<<8)); }
+static uint32_t rd32(const uint8_t* p){ return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+static uint64_t rd64(const uint8_t* p){ return (uint64_t)rd32(p) | ((uint64_t)rd32(p+4)<<32); }
+
+static void wr16(uint8_t* p, uint16_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static void wr32(uint8_t* p, uint32_t v){ wr16(p,(uint16_t)v); wr16(p+2,(uint16_t)(v>>16)); }
+static void wr64(uint8_t* p, uint64_t v){ wr32(p,(uint32_t)v); wr32(p+4,(uint32_t)(v>>32)); }
+
+/* ---- mapping ---- */
+
+static int map_file(bej_arc* A, const char* path){
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return 0;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX){ close(fd); return 0; }
+    void* m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) return 0;
+    A->base = (const uint8_t*)m; A->size = (size_t)st.st_size; A->mapped = 1;
+    return 1;
+#else
+    FILE* f = fopen(path, "rb"); if(!f) return 0;
+    _fseeki64(f,0,SEEK_END); long long sz = arc_ftell(f); arc_fseek(f,0);
+    if(sz <= 0 || (unsigned long long)sz > SIZE_MAX){ fclose(f); return 0; }
+    uint8_t* b = (uint8_t*)malloc((size_t)sz);
+    if(!b || fread(b,1,(size_t)sz,f) != (size_t)sz){ free(b); fclose(f); return 0; }
+    fclose(f);
+    A->base = b; A->size = (size_t)sz; A->mapped = 0;
+    return 1;
+#endif
+}
+
+static void unmap_file(bej_arc* A){
+    if(!A->base) return;
+#ifndef _WIN32
+    if(A->mapped){ munmap((void*)A->base, A->size); return; }
+#endif
+    free((void*)A->base);
+}
+
+/* ---- index ---- */
+
+static int push_ent(bej_arc* A, const bej_arc_ent* e, size_t* cap){
+    if(A->n == *cap){
+        size_t nc = *cap ? *cap*2 : 64;
+        if(nc > SIZE_MAX / sizeof(bej_arc_ent)) return 0;
+        bej_arc_ent* a = (bej_arc_ent*)realloc(A->ent, nc*sizeof(*a));
+        if(!a) return 0;
+        A->ent = a; *cap = nc;
+    }
+    A->ent[A->n++] = *e;
+    return 1;
+}
+
+/* Read the footer index. Returns 0 if there is no valid trailer. */
+static int load_index(bej_arc* A){
+    if(A->size < ARC_HDR_N + ARC_TRAILER_N) return 0;
+    const uint8_t* t = A->base + A->size - ARC_TRAILER_N;
+    if(memcmp(t+20, "BEJI", 4) != 0 || rd32(t+16) != ARC_VERSION) return 0;
+    uint64_t io = rd64(t), cnt = rd64(t+8);
+    if(io < ARC_HDR_N || io > A->size - ARC_TRAILER_N) return 0;
+    if(cnt != (A->size - ARC_TRAILER_N - io) / ARC_IDX_N || (A->size - ARC_TRAILER_N - io) % ARC_IDX_N) return 0;
+
+    if(cnt > SIZE_MAX / sizeof(bej_arc_ent)) return 0;   /* 32-bit hosts: entries outgrow the 48-byte records */
+    A->ent = (bej_arc_ent*)malloc((size_t)(cnt ? cnt : 1) * sizeof(bej_arc_ent));
+    if(!A->ent) return 0;
+    for(uint64_t i=0;i<cnt;i++){
+        const uint8_t* q = A->base + io + i*ARC_IDX_N;
+        bej_arc_ent* e = &A->ent[i];
+        e->rec_off = rd64(q); e->ts = rd64(q+8); e->dict_id = rd64(q+16);
+        e->payload_off = rd64(q+24); e->payload_len = rd64(q+32);
+        e->res_len = rd16(q+44);
+        if(e->payload_off > io || e->payload_len > io - e->payload_off ||
+           e->rec_off > io || io - e->rec_off < ARC_REC_N || e->res_len > io - e->rec_off - ARC_REC_N){
+            free(A->ent); A->ent = NULL; return 0;
+        }
+        e->res_off = e->rec_off + ARC_REC_N;
+    }
+    A->n = (size_t)cnt;
+    A->data_end = io;
+    return 1;
+}
+
+/* Rebuild the index by walking the records; stops at the first damaged one. */
+static int scan_records(bej_arc* A){
+    size_t cap = 0, p = ARC_HDR_N;
+    A->n = 0;
+    while(p + ARC_REC_N <= A->size && memcmp(A->base+p, "BREC", 4)==0){
+        const uint8_t* q = A->base + p;
+        bej_arc_ent e;
+        e.rec_off = p; e.ts = rd64(q+4); e.dict_id = rd64(q+12);
+        e.payload_len = rd64(q+20); e.res_len = rd16(q+28);
+        e.res_off = p + ARC_REC_N;
+        uint64_t body = (uint64_t)ARC_REC_N + e.res_len;
+        if(body > A->size - p || e.payload_len > A->size - p - body) break;
+        e.payload_off = p + body;
+        if(!push_ent(A, &e, &cap)) return 0;
+        p = (size_t)(e.payload_off + e.payload_len);
+    }
+    A->data_end = p;
+    return 1;
+}
+
+/**
+ * @brief Open (map) an archive for reading.
+ *
+ * Uses the footer index when present, otherwise rebuilds it from the records.
+ * @param A Output archive handle.
+ * @param path Archive file.
+ * @return 1 on success, 0 if the file cannot be read or is not an archive.
+ */
+int bej_arc_open(bej_arc* A, const char* path){
+    if(!A || !path) return 0;
+    memset(A, 0, sizeof(*A));
+    if(!map_file(A, path)) return 0;
+    if(A->size < ARC_HDR_N || memcmp(A->base, "BEJA", 4)!=0 || rd16(A->base+4)!=ARC_VERSION){
+        bej_arc_close(A); return 0;
+    }
+    if(!load_index(A)){
+        A->recovered = 1;
+        if(!scan_records(A)){ bej_arc_close(A); return 0; }
+    }
+    return 1;
+}
+
+/** @brief Unmap an archive and free its index. */
+void bej_arc_close(bej_arc* A){
+    if(!A) return;
+    unmap_file(A);
+    free(A->ent);
+    memset(A, 0, sizeof(*A));
+}
+
+/**
+ * @brief Payload bytes of record @p i (points into the mapping).
+ * @return Pointer to the payload, or NULL if @p i is out of range.
+ */
+const uint8_t* bej_arc_payload(const bej_arc* A, size_t i, size_t* n){
+    if(!A || i >= A->n) return NULL;
+    if(n) *n = (size_t)A->ent[i].payload_len;
+    return A->base + A->ent[i].payload_off;
+}
+
+/**
+ * @brief Resource id of record @p i (not NUL-terminated; points into the mapping).
+ * @return Pointer to the resource id bytes, or NULL if @p i is out of range.
+ */
+const char* bej_arc_resource(const bej_arc* A, size_t i, size_t* n){
+    if(!A || i >= A->n) return NULL;
+    if(n) *n = A->ent[i].res_len;
+    return (const char*)A->base + A->ent[i].res_off;
+}
+
+/* ---- writer ---- */
+
+/**
+ * @brief Open an archive for appending, creating it if it does not exist.
+ *
+ * The existing index is kept in memory; new records overwrite the old footer
+ * and bej_arc_writer_close() writes the combined index.
+ * @return 1 on success, 0 on I/O error or if @p path is not an archive.
+ */
+int bej_arc_writer_open(bej_arc_writer* W, const char* path){
+    if(!W || !path) return 0;
+    memset(W, 0, sizeof(*W));
+    bej_arc A;
+    FILE* probe = fopen(path, "rb");
+    if(probe){
+        int empty = fgetc(probe)==EOF; fclose(probe);
+        if(!empty){
+            if(!bej_arc_open(&A, path)) return 0;
+            W->ent = A.ent; W->n = W->cap = A.n; A.ent = NULL;
+            W->pos = A.data_end;
+            if(A.recovered){
+                /* Drop whatever follows the last intact record */
+                size_t keep = (size_t)A.data_end;
+                uint8_t* copy = (uint8_t*)malloc(keep);
+                if(!copy){ bej_arc_close(&A); free(W->ent); return 0; }
+                memcpy(copy, A.base, keep);
+                bej_arc_close(&A);
+                W->f = fopen(path, "w+b");
+                if(!W->f || fwrite(copy,1,keep,W->f)!=keep){ free(copy); free(W->ent); if(W->f) fclose(W->f); return 0; }
+                free(copy);
+                return 1;
+            }
+            bej_arc_close(&A);
+            W->f = fopen(path, "r+b");
+            if(!W->f || arc_fseek(W->f, W->pos)!=0){ free(W->ent); if(W->f) fclose(W->f); return 0; }
+            return 1;
+        }
+    }
+    W->f = fopen(path, "w+b");
+    if(!W->f) return 0;
+    uint8_t h[ARC_HDR_N];
+    memcpy(h, "BEJA", 4); wr16(h+4, ARC_VERSION); wr16(h+6, 0);
+    if(fwrite(h,1,sizeof(h),W->f)!=sizeof(h)){ fclose(W->f); return 0; }
+    W->pos = ARC_HDR_N;
+    return 1;
+}
+
+/**
+ * @brief Append one payload.
+ * @param W Writer.
+ * @param ts Timestamp (caller-defined unit; the CLI uses Unix milliseconds).
+ * @param resource Resource id, e.g. "/redfish/v1/Systems/1/Memory/DIMM0" (max 65535 bytes).
+ * @param dict_id Identity of the dictionary the payload is encoded with (@ref bej_dict::id).
+ * @param bej Payload bytes.
+ * @param bej_n Payload length.
+ * @return 1 on success, 0 on I/O error.
+ */
+int bej_arc_writer_add(bej_arc_writer* W, uint64_t ts, const char* resource, uint64_t dict_id,
+                       const uint8_t* bej, size_t bej_n){
+    if(!W || !W->f || !resource || (!bej && bej_n)) return 0;
+    size_t rl = strlen(resource);
+    if(rl > 0xFFFF) return 0;
+    uint8_t h[ARC_REC_N];
+    memcpy(h, "BREC", 4); wr64(h+4, ts); wr64(h+12, dict_id); wr64(h+20, bej_n); wr16(h+28, (uint16_t)rl);
+    wr32(h+30, 0);
+    if(fwrite(h,1,sizeof(h),W->f)!=sizeof(h)) return 0;
+    if(fwrite(resource,1,rl,W->f)!=rl) return 0;
+    if(bej_n && fwrite(bej,1,bej_n,W->f)!=bej_n) return 0;
+
+    if(W->n == W->cap){
+        size_t nc = W->cap ? W->cap*2 : 64;
+        if(nc > SIZE_MAX / sizeof(bej_arc_ent)) return 0;
+        bej_arc_ent* a = (bej_arc_ent*)realloc(W->ent, nc*sizeof(*a));
+        if(!a) return 0;
+        W->ent = a; W->cap = nc;
+    }
+    bej_arc_ent* e = &W->ent[W->n++];
+    e->rec_off = W->pos; e->ts = ts; e->dict_id = dict_id;
+    e->res_off = W->pos + ARC_REC_N; e->res_len = (uint16_t)rl;
+    e->payload_off = W->pos + ARC_REC_N + rl; e->payload_len = bej_n;
+    W->pos = e->payload_off + bej_n;
+    return 1;
+}
+
+/**
+ * @brief Write the footer index and close the archive.
+ * @return 1 on success, 0 on I/O error (the records remain recoverable).
+ */
+int bej_arc_writer_close(bej_arc_writer* W){
+    if(!W || !W->f) return 0;
+    int ok = 1;
+    uint8_t q[ARC_IDX_N];
+    for(size_t i=0;i<W->n && ok;i++){
+        const bej_arc_ent* e = &W->ent[i];
+        wr64(q, e->rec_off); wr64(q+8, e->ts); wr64(q+16, e->dict_id);
+        wr64(q+24, e->payload_off); wr64(q+32, e->payload_len);
+        wr32(q+40, 0); wr16(q+44, e->res_len); wr16(q+46, 0);
+        ok = fwrite(q,1,sizeof(q),W->f)==sizeof(q);
+    }
+    uint8_t t[ARC_TRAILER_N];
+    wr64(t, W->pos); wr64(t+8, W->n); wr32(t+16, ARC_VERSION); memcpy(t+20, "BEJI", 4);
+    if(ok) ok = fwrite(t,1,sizeof(t),W->f)==sizeof(t);
+    if(fclose(W->f)!=0) ok = 0;
+    free(W->ent);
+    memset(W, 0, sizeof(*W));
+    return ok;
+}
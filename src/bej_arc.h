@@ -0,0 +1,11 @@
+#ifndef BEJ_ARC_H_
+#define BEJ_ARC_H_
+
+/**
+ * @file bej_arc.h
+ * @brief Append-only, footer-indexed archive of BEJ payloads.
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_ARC_H_ */
@@ -0,0 +1,200 @@
+/**
+ * @file bej_cache.c
+ * @brief Content-addressed cache of rendered JSON, keyed by payload bytes + dictionary.
+ *
+ * A hit returns the previously rendered output without decoding. Entries keep
+ * a copy of the payload so a hash collision can never return foreign output.
+ * Memory is bounded by a byte limit; the least recently used entries are
+ * evicted first.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "bej.h"
+
+typedef struct bej_cache_ent bej_cache_ent;
+struct bej_cache_ent {
+    bej_cache_ent* hnext;  /**< Next entry in the same hash bucket. */
+    bej_cache_ent* prev;   /**< LRU list (towards most recently used). */
+    bej_cache_ent* next;   /**< LRU list (towards least recently used). */
+    uint64_t h;            /**< Hash of payload bytes seeded with the dictionary id. */
+    uint64_t dict_id;
+    size_t   key_n;        /**< Payload length. */
+    size_t   out_n;        /**< Rendered output length. */
+    uint8_t  data[];       /**< Payload bytes followed by rendered output. */
+};
+
+struct bej_cache {
+    bej_cache_ent** bucket;
+    size_t          nbucket;   /**< Power of two. */
+    bej_cache_ent*  head;      /**< Most recently used. */
+    bej_cache_ent*  tail;      /**< Least recently used. */
+    size_t          limit;     /**< Memory limit in bytes. */
+    char*           scratch;   /**< Output that was too large to cache. */
+    bej_cache_stats st;
+};
+
+static uint64_t rd64(const uint8_t* p){ uint64_t v; memcpy(&v,p,8); return v; }
+
+/**
+ * @brief Fast non-cryptographic 64-bit hash (MurmurHash64A).
+ * @param data Bytes to hash.
+ * @param n Number of bytes.
+ * @param seed Seed (e.g. a dictionary id).
+ * @return 64-bit hash value.
+ */
+uint64_t bej_hash64(const void* data, size_t n, uint64_t seed){
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = seed ^ ((uint64_t)n * m);
+    for(size_t i=0;i<n/8;i++,p+=8){
+        uint64_t k = rd64(p);
+        k *= m; k ^= k >> r; k *= m;
+        h ^= k; h *= m;
+    }
+    size_t t = n & 7;
+    if(t){
+        uint64_t k = 0;
+        for(size_t i=0;i<t;i++) k |= (uint64_t)p[i] << (8*i);
+        h ^= k; h *= m;
+    }
+    h ^= h >> r; h *= m; h ^= h >> r;
+    return h;
+}
+
+static size_t ent_bytes(const bej_cache_ent* e){ return sizeof(*e) + e->key_n + e->out_n; }
+
+static void lru_unlink(bej_cache* c, bej_cache_ent* e){
+    if(e->prev) e->prev->next = e->next; else c->head = e->next;
+    if(e->next) e->next->prev = e->prev; else c->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_push_front(bej_cache* c, bej_cache_ent* e){
+    e->prev = NULL; e->next = c->head;
+    if(c->head) c->head->prev = e; else c->tail = e;
+    c->head = e;
+}
+
+static void evict_one(bej_cache* c){
+    bej_cache_ent* e = c->tail;
+    bej_cache_ent** pp = &c->bucket[e->h & (c->nbucket-1)];
+    while(*pp != e) pp = &(*pp)->hnext;
+    *pp = e->hnext;
+    lru_unlink(c, e);
+    c->st.bytes -= ent_bytes(e);
+    c->st.entries--;
+    c->st.evictions++;
+    free(e);
+}
+
+static void grow_buckets(bej_cache* c){
+    size_t nb = c->nbucket*2;
+    bej_cache_ent** b = (bej_cache_ent**)calloc(nb, sizeof(*b));
+    if(!b) return; /* keep the old table; chains just get longer */
+    for(size_t i=0;i<c->nbucket;i++){
+        bej_cache_ent* e = c->bucket[i];
+        while(e){
+            bej_cache_ent* nx = e->hnext;
+            e->hnext = b[e->h & (nb-1)]; b[e->h & (nb-1)] = e;
+            e = nx;
+        }
+    }
+    free(c->bucket); c->bucket=b; c->nbucket=nb;
+}
+
+/**
+ * @brief Create a cache bounded by @p mem_limit bytes (payload copies, output and bookkeeping).
+ * @return New cache, or NULL on allocation failure.
+ */
+bej_cache* bej_cache_new(size_t mem_limit){
+    bej_cache* c = (bej_cache*)calloc(1, sizeof(*c));
+    if(!c) return NULL;
+    c->nbucket = 64;
+    c->bucket = (bej_cache_ent**)calloc(c->nbucket, sizeof(*c->bucket));
+    if(!c->bucket){ free(c); return NULL; }
+    c->limit = mem_limit;
+    return c;
+}
+
+/** @brief Free a cache and every cached output. */
+void bej_cache_free(bej_cache* c){
+    if(!c) return;
+    bej_cache_ent* e = c->head;
+    while(e){ bej_cache_ent* nx = e->next; free(e); e = nx; }
+    free(c->bucket); free(c->scratch); free(c);
+}
+
+/**
+ * @brief Return the JSON rendering of a payload, decoding only on a cache miss.
+ *
+ * @param c Cache.
+ * @param bej BEJ payload (bejEncoding header + root Set).
+ * @param bej_n Length of @p bej.
+ * @param D Schema dictionary; its @ref bej_dict::id is part of the key.
+ * @param out Output: rendered JSON (identical to bej_decode_to_json() output).
+ *            Owned by the cache and valid until the next call on @p c.
+ * @param out_n Output: length of @p out.
+ * @return 1 on success, 0 on malformed input or allocation failure.
+ */
+int bej_cache_decode(bej_cache* c, const uint8_t* bej, size_t bej_n, const bej_dict* D,
+                     const char** out, size_t* out_n){
+    if(!c || !bej || !D || !out || !out_n) return 0;
+    uint64_t h = bej_hash64(bej, bej_n, D->id);
+
+    for(bej_cache_ent* e = c->bucket[h & (c->nbucket-1)]; e; e = e->hnext){
+        if(e->h==h && e->dict_id==D->id && e->key_n==bej_n && memcmp(e->data, bej, bej_n)==0){
+            c->st.hits++;
+            if(c->head != e){ lru_unlink(c, e); lru_push_front(c, e); }
+            *out = (const char*)e->data + e->key_n; *out_n = e->out_n;
+            return 1;
+        }
+    }
+    c->st.misses++;
+
+    char* js; size_t jn;
+    if(!bej_decode_to_mem(bej, bej_n, D, &js, &jn)) return 0;
+
+    size_t need = sizeof(bej_cache_ent) + bej_n + jn;
+    if(need > c->limit){
+        /* Never fits: hand out the rendering without caching it */
+        free(c->scratch); c->scratch = js;
+        *out = js; *out_n = jn;
+        return 1;
+    }
+    while(c->st.bytes + need > c->limit) evict_one(c);
+
+    bej_cache_ent* e = (bej_cache_ent*)malloc(need);
+    if(!e){ free(c->scratch); c->scratch = js; *out = js; *out_n = jn; return 1; }
+    e->h = h; e->dict_id = D->id; e->key_n = bej_n; e->out_n = jn;
+    memcpy(e->data, bej, bej_n);
+    memcpy(e->data + bej_n, js, jn);
+    free(js);
+
+    if(c->st.entries >= c->nbucket) grow_buckets(c);
+    size_t b = h & (c->nbucket-1);
+    e->hnext = c->bucket[b]; c->bucket[b] = e;
+    lru_push_front(c, e);
+    c->st.bytes += need;
+    c->st.entries++;
+
+    *out = (const char*)e->data + bej_n; *out_n = jn;
+    return 1;
+}
+
+/**
+ * @brief Decode through the cache and write the JSON to a FILE*.
+ * @return 1 on success, 0 on malformed input or write failure.
+ */
+int bej_cache_decode_to_json(bej_cache* c, FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D){
+    const char* js; size_t jn;
+    if(!out || !bej_cache_decode(c, bej, bej_n, D, &js, &jn)) return 0;
+    return fwrite(js, 1, jn, out)==jn;
+}
+
+/** @brief Snapshot hit/miss/eviction counters and memory use. */
+void bej_cache_get_stats(const bej_cache* c, bej_cache_stats* st){
+    if(!c || !st) return;
+    *st = c->st;
+}
@@ -0,0 +1,11 @@
+#ifndef BEJ_CACHE_H_
+#define BEJ_CACHE_H_
+
+/**
+ * @file bej_cache.h
+ * @brief Content-addressed LRU cache of rendered JSON output.
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_CACHE_H_ */
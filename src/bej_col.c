@@ -0,0 +1,369 @@
+/**
+ * @file bej_col.c
+ * @brief Columnar sink: a batch of payloads decoded straight into typed columns.
+ *
+ * The column set is derived from the dictionary once: every Int, String and
+ * Enum property reachable from the root through Sets becomes one column named
+ * by its path (`MemoryLocation/Slot`). Each payload appends one row; members
+ * are routed to their column by sequence number with no text stage, and
+ * properties a payload does not carry stay null. Arrays and other formats
+ * are skipped by length.
+ *
+ * Column layouts follow Arrow conventions: LSB-first validity bitmaps, int64
+ * values, 64-bit string offsets into one data buffer, and enums as indices
+ * into the per-column option dictionary.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "bej.h"
+
+/* Per-Set routing table: member seq -> column or nested Set node (-1: skip) */
+typedef struct { int32_t col; int32_t node; } col_slot;
+struct bej_col_node {
+    col_slot* slot;
+    size_t    nslot;
+};
+
+/* ---- schema ---- */
+
+static int32_t add_node(bej_colset* C){
+    bej_col_node* n = (bej_col_node*)realloc(C->node, (C->nnode+1)*sizeof(*n));
+    if(!n) return -1;
+    C->node = n;
+    C->node[C->nnode].slot = NULL; C->node[C->nnode].nslot = 0;
+    return (int32_t)C->nnode++;
+}
+
+static int32_t add_col(bej_colset* C, const char* path, const bej_dict_entry* de){
+    bej_col* c = (bej_col*)realloc(C->col, (C->ncol+1)*sizeof(*c));
+    if(!c) return -1;
+    C->col = c;
+    c = &C->col[C->ncol];
+    memset(c, 0, sizeof(*c));
+    c->fmt = (uint8_t)(de->fmt >> 4);
+    c->path = (char*)malloc(strlen(path)+1);
+    if(!c->path) return -1;
+    strcpy(c->path, path);
+    if(c->fmt==BEJ_FMT_ENUM){
+        /* Option dictionary indexed by ordinal */
+        bej_cluster oc = bej_dict_child_cluster(C->D, de);
+        uint32_t end = oc.start_idx + oc.count;
+        if(end > C->D->n) end = (uint32_t)C->D->n;
+        uint32_t n = 0;
+        for(uint32_t i=oc.start_idx;i<end;i++) if((uint32_t)C->D->ent[i].seq+1 > n) n = (uint32_t)C->D->ent[i].seq+1;
+        if(n){
+            c->opts = (const char**)calloc(n, sizeof(char*));
+            if(!c->opts){ free(c->path); return -1; }
+            for(uint32_t o=0;o<n;o++){
+                const bej_dict_entry* e = bej_cluster_lookup_seq(C->D, oc, o);
+                c->opts[o] = (e && e->name_off) ? bej_dict_name_at(C->D, e->name_off) : NULL;
+            }
+            c->nopts = n;
+        }
+    }
+    return (int32_t)C->ncol++;
+}
+
+/* Fill node's routing table from cluster cl; ancestors guard against cycles */
+static int build_node(bej_colset* C, int32_t node, bej_cluster cl, char* path, size_t plen,
+                      const bej_cluster* anc, int depth){
+    const bej_dict* D = C->D;
+    uint32_t end = cl.start_idx + cl.count;
+    if(end > D->n) end = (uint32_t)D->n;
+    size_t nslot = 0;
+    for(uint32_t i=cl.start_idx;i<end;i++) if((size_t)D->ent[i].seq+1 > nslot) nslot = (size_t)D->ent[i].seq+1;
+    if(!nslot) return 1;
+    col_slot* s = (col_slot*)malloc(nslot*sizeof(*s));
+    if(!s) return 0;
+    for(size_t k=0;k<nslot;k++){ s[k].col=-1; s[k].node=-1; }
+    C->node[node].slot = s; C->node[node].nslot = nslot;
+
+    bej_cluster chain[BEJ_COL_MAX_DEPTH+1];
+    if(depth) memcpy(chain, anc, (size_t)depth*sizeof(bej_cluster));
+    chain[depth] = cl;
+    for(uint32_t i=cl.start_idx;i<end;i++){
+        const bej_dict_entry* de = bej_cluster_lookup_seq(D, cl, D->ent[i].seq);
+        if(de != &D->ent[i]) continue;   /* duplicate seq: the lookup picks another entry */
+        const char* name = de->name_off ? bej_dict_name_at(D, de->name_off) : NULL;
+        if(!name) continue;
+        size_t nn = strlen(name);
+        if(plen + nn + 2 > BEJ_COL_MAX_PATH) continue;
+        char* q = path + plen;
+        if(plen) *q++ = '/';
+        memcpy(q, name, nn+1);
+        size_t sub_len = (size_t)(q - path) + nn;
+
+        uint8_t fmt = (uint8_t)(de->fmt >> 4);
+        if(fmt==BEJ_FMT_INT || fmt==BEJ_FMT_STRING || fmt==BEJ_FMT_ENUM){
+            int32_t c = add_col(C, path, de);
+            if(c < 0) return 0;
+            C->node[node].slot[de->seq].col = c;
+        }else if(fmt==BEJ_FMT_SET && depth+1 < BEJ_COL_MAX_DEPTH){
+            bej_cluster cc = bej_dict_child_cluster(D, de);
+            int cyc = 0;
+            for(int k=0;k<=depth;k++) if(chain[k].start_idx==cc.start_idx && chain[k].count==cc.count) cyc = 1;
+            if(cyc || !cc.count) continue;
+            int32_t child = add_node(C);
+            if(child < 0) return 0;
+            C->node[node].slot[de->seq].node = child;
+            if(!build_node(C, child, cc, path, sub_len, chain, depth+1)) return 0;
+        }
+        path[plen] = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Derive the column set of a dictionary.
+ * @param C Output column set (release with bej_colset_free()).
+ * @param D Dictionary shared by every payload of the batch; must outlive @p C.
+ * @return 1 on success, 0 on allocation failure.
+ */
+int bej_colset_init(bej_colset* C, const bej_dict* D){
+    if(!C || !D) return 0;
+    memset(C, 0, sizeof(*C));
+    C->D = D;
+    char path[BEJ_COL_MAX_PATH]; path[0] = 0;
+    int32_t root = add_node(C);
+    if(root < 0 || !build_node(C, root, bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL), path, 0, NULL, 0)){
+        bej_colset_free(C);
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Release all columns. */
+void bej_colset_free(bej_colset* C){
+    if(!C) return;
+    for(size_t i=0;i<C->ncol;i++){
+        bej_col* c = &C->col[i];
+        free(c->path); free(c->valid); free(c->i64); free(c->idx); free(c->off); free(c->data); free(c->opts);
+    }
+    for(size_t i=0;i<C->nnode;i++) free(C->node[i].slot);
+    free(C->col); free(C->node);
+    memset(C, 0, sizeof(*C));
+}
+
+/**
+ * @brief Find a column by property path.
+ * @return The column, or NULL if the path is not a column.
+ */
+const bej_col* bej_colset_find(const bej_colset* C, const char* path){
+    if(!C || !path) return NULL;
+    for(size_t i=0;i<C->ncol;i++) if(strcmp(C->col[i].path, path)==0) return &C->col[i];
+    return NULL;
+}
+
+/* ---- rows ---- */
+
+static int grow_rows(bej_colset* C){
+    size_t cap = C->cap ? C->cap*2 : 64;
+    for(size_t i=0;i<C->ncol;i++){
+        bej_col* c = &C->col[i];
+        uint8_t* v = (uint8_t*)realloc(c->valid, (cap+7)/8);
+        if(!v) return 0;
+        memset(v + (C->cap+7)/8, 0, (cap+7)/8 - (C->cap+7)/8);
+        c->valid = v;
+        if(c->fmt==BEJ_FMT_INT){
+            int64_t* p = (int64_t*)realloc(c->i64, cap*sizeof(*p)); if(!p) return 0; c->i64 = p;
+        }else if(c->fmt==BEJ_FMT_ENUM){
+            uint32_t* p = (uint32_t*)realloc(c->idx, cap*sizeof(*p)); if(!p) return 0; c->idx = p;
+        }else{
+            uint64_t* p = (uint64_t*)realloc(c->off, (cap+1)*sizeof(*p)); if(!p) return 0;
+            if(!c->off) p[0] = 0;
+            c->off = p;
+        }
+    }
+    C->cap = cap;
+    return 1;
+}
+
+static int str_append(bej_col* c, const uint8_t* s, size_t n){
+    if(n==0) return 1;
+    if(c->data_n + n > c->data_cap){
+        size_t cap = c->data_cap ? c->data_cap : 256;
+        while(cap < c->data_n + n) cap *= 2;
+        char* d = (char*)realloc(c->data, cap);
+        if(!d) return 0;
+        c->data = d; c->data_cap = cap;
+    }
+    memcpy(c->data + c->data_n, s, n); c->data_n += n;
+    return 1;
+}
+
+#define ROW_BIT(c,r)  ((c)->valid[(r)>>3] &  (uint8_t)(1u << ((r)&7)))
+#define ROW_SET(c,r)  ((c)->valid[(r)>>3] |= (uint8_t)(1u << ((r)&7)))
+
+/* Store one value; the first occurrence of a member in a row wins */
+static int col_store(bej_col* c, size_t r, uint8_t fmt, const uint8_t* v, uint64_t L){
+    if(fmt != c->fmt || ROW_BIT(c, r)) return 1;
+    if(fmt==BEJ_FMT_INT){
+        /* Same (unsigned, little-endian) interpretation as the JSON decoder */
+        if(L > 8) return 0;
+        int64_t x = 0;
+        for(size_t i=0;i<(size_t)L;i++) x |= (int64_t)((uint64_t)v[i] << (8*i));
+        c->i64[r] = x;
+    }else if(fmt==BEJ_FMT_ENUM){
+        bej_br ev; bej_br_init(&ev, v, (size_t)L);
+        uint64_t o; if(!bej_read_nnint(&ev, &o)) return 0;
+        if(o >= c->nopts || !c->opts[o]) return 1;   /* unknown option: null */
+        c->idx[r] = (uint32_t)o;
+    }else{
+        /* Ends at the first NUL, like the decoder renders it */
+        size_t n = 0;
+        while(n < (size_t)L && v[n]) n++;
+        if(!str_append(c, v, n)) return 0;
+        c->off[r+1] = c->data_n;
+    }
+    ROW_SET(c, r);
+    return 1;
+}
+
+static int col_set(bej_colset* C, bej_br* br, int32_t node, size_t r, int depth){
+    if(depth > BEJ_COL_MAX_DEPTH) return 0;
+    const bej_col_node* nd = &C->node[node];
+    uint64_t count; if(!bej_read_nnint(br,&count)) return 0;
+    for(uint64_t i=0;i<count;i++){
+        uint64_t S; if(!bej_read_nnint(br,&S)) return 0;
+        uint8_t  F; if(!bej_br_u8(br,&F)) return 0;
+        uint64_t L; if(!bej_read_nnint(br,&L)) return 0;
+        if(L > bej_br_left(br)) return 0;
+        size_t end = br->p + (size_t)L;
+        uint64_t seq = S >> 1;
+        if(!(S & 1u) && seq < nd->nslot){
+            const col_slot* s = &nd->slot[seq];
+            uint8_t fmt = (uint8_t)(F >> 4);
+            if(s->col >= 0){
+                if(!col_store(&C->col[s->col], r, fmt, br->d + br->p, L)) return 0;
+            }else if(s->node >= 0 && fmt==BEJ_FMT_SET){
+                bej_br sub; bej_br_init(&sub, br->d + br->p, (size_t)L);
+                if(!col_set(C, &sub, s->node, r, depth+1)) return 0;
+            }
+        }
+        br->p = end;   /* everything else is skipped by length */
+    }
+    return 1;
+}
+
+/**
+ * @brief Decode one payload into a new row of every column.
+ *
+ * @param C Column set.
+ * @param bej BEJ payload (bejEncoding header + root Set) encoded with the set's dictionary.
+ * @param bej_n Length of @p bej.
+ * @return 1 on success; 0 on malformed input or allocation failure (no row is added).
+ */
+int bej_colset_add(bej_colset* C, const uint8_t* bej, size_t bej_n){
+    if(!C || !bej) return 0;
+    if(C->rows == C->cap && !grow_rows(C)) return 0;
+    size_t r = C->rows;
+    for(size_t i=0;i<C->ncol;i++){
+        bej_col* c = &C->col[i];
+        if(c->fmt==BEJ_FMT_INT) c->i64[r] = 0;
+        else if(c->fmt==BEJ_FMT_ENUM) c->idx[r] = 0;
+        else c->off[r+1] = c->off[r];
+    }
+
+    bej_br br; bej_br_init(&br, bej, bej_n);
+    uint64_t S, L; uint8_t F;
+    int ok = bej_br_seek(&br, 7) && bej_read_nnint(&br,&S) && bej_br_u8(&br,&F) && bej_read_nnint(&br,&L)
+          && (F>>4)==BEJ_FMT_SET && col_set(C, &br, 0, r, 0);
+    if(!ok){
+        /* Roll back the partial row */
+        for(size_t i=0;i<C->ncol;i++){
+            bej_col* c = &C->col[i];
+            c->valid[r>>3] &= (uint8_t)~(1u << (r&7));
+            if(c->fmt==BEJ_FMT_STRING){ c->data_n = (size_t)c->off[r]; c->off[r+1] = c->off[r]; }
+        }
+        return 0;
+    }
+    C->rows++;
+    return 1;
+}
+
+/* ---- file ---- */
+
+static int wr(FILE* f, const void* p, size_t n){ return n==0 || fwrite(p,1,n,f)==n; }
+static int wr_u16(FILE* f, uint16_t v){ uint8_t b[2] = { (uint8_t)v, (uint8_t)(v>>8) }; return wr(f,b,2); }
+static int wr_u32(FILE* f, uint32_t v){ return wr_u16(f,(uint16_t)v) && wr_u16(f,(uint16_t)(v>>16)); }
+static int wr_u64(FILE* f, uint64_t v){ return wr_u32(f,(uint32_t)v) && wr_u32(f,(uint32_t)(v>>32)); }
+static int wr_pad(FILE* f, uint64_t* pos, uint64_t n){
+    static const uint8_t z[8] = {0};
+    size_t k = (size_t)((8 - (*pos + n) % 8) % 8);
+    *pos += n + k;
+    return wr(f, z, k);
+}
+/* n little-endian words of width w (8: from p64, 4: from p32), staged in chunks */
+static int wr_words(FILE* f, const uint64_t* p64, const uint32_t* p32, size_t n, size_t w){
+    uint8_t chunk[4096];
+    size_t k = 0;
+    for(size_t i=0;i<n;i++){
+        uint64_t v = w==8 ? p64[i] : p32[i];
+        for(size_t b=0;b<w;b++) chunk[k++] = (uint8_t)(v >> (8*b));
+        if(k + w > sizeof(chunk)){ if(!wr(f, chunk, k)) return 0; k = 0; }
+    }
+    return wr(f, chunk, k);
+}
+
+/* Buffer: u64 length, bytes, zero padding to 8 */
+static int wr_buf(FILE* f, uint64_t* pos, const void* p, uint64_t n){
+    *pos += 8;
+    return wr_u64(f, n) && wr(f, p, (size_t)n) && wr_pad(f, pos, n);
+}
+
+/**
+ * @brief Write the column set as a self-describing columnar file.
+ *
+ * Layout (little-endian, every section 8-byte aligned):
+ * - header (32 bytes): "BEJC", u16 version, u16 0, u64 rows, u64 dictionary id,
+ *   u32 ncols, u32 0;
+ * - per column: u8 format, u8 0, u16 path length, path; Enum columns add
+ *   u32 option count and per option u16 length + name (length 0: no name);
+ *   zero padding to 8;
+ * - per column, buffers as u64 length + bytes + padding: the validity bitmap,
+ *   then int64 values (Int), u32 option indices (Enum) or u64 offsets
+ *   (rows+1) and UTF-8 data (String).
+ *
+ * @param C Column set.
+ * @param out Output stream (binary).
+ * @return 1 on success, 0 on write error.
+ */
+int bej_colset_write(const bej_colset* C, FILE* out){
+    if(!C || !out) return 0;
+    uint64_t pos = 32;
+    int ok = wr(out, BEJ_COL_MAGIC, 4) && wr_u16(out, BEJ_COL_VERSION) && wr_u16(out, 0)
+          && wr_u64(out, C->rows) && wr_u64(out, C->D->id) && wr_u32(out, (uint32_t)C->ncol) && wr_u32(out, 0);
+    for(size_t i=0;i<C->ncol && ok;i++){
+        const bej_col* c = &C->col[i];
+        size_t pn = strlen(c->path);
+        uint64_t n = 4 + pn;
+        ok = wr(out, &c->fmt, 1) && wr(out, "", 1) && wr_u16(out, (uint16_t)pn) && wr(out, c->path, pn);
+        if(ok && c->fmt==BEJ_FMT_ENUM){
+            ok = wr_u32(out, c->nopts); n += 4;
+            for(uint32_t o=0;o<c->nopts && ok;o++){
+                size_t on = c->opts[o] ? strlen(c->opts[o]) : 0;
+                ok = wr_u16(out, (uint16_t)on) && wr(out, c->opts[o], on); n += 2 + on;
+            }
+        }
+        ok = ok && wr_pad(out, &pos, n);
+    }
+    for(size_t i=0;i<C->ncol && ok;i++){
+        const bej_col* c = &C->col[i];
+        ok = wr_buf(out, &pos, c->valid, (C->rows+7)/8);
+        if(!ok) break;
+        if(c->fmt==BEJ_FMT_INT){
+            pos += 8; ok = wr_u64(out, C->rows*8) && wr_words(out, (const uint64_t*)c->i64, NULL, C->rows, 8);
+            pos += C->rows*8;
+        }else if(c->fmt==BEJ_FMT_ENUM){
+            pos += 8; ok = wr_u64(out, C->rows*4) && wr_words(out, NULL, c->idx, C->rows, 4);
+            ok = ok && wr_pad(out, &pos, C->rows*4);
+        }else{
+            static const uint64_t zero = 0;
+            pos += 8; ok = wr_u64(out, (C->rows+1)*8) && wr_words(out, c->off ? c->off : &zero, NULL, c->off ? C->rows+1 : 1, 8);
+            pos += (C->rows+1)*8;
+            ok = ok && wr_buf(out, &pos, c->data, c->data_n);
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,11 @@
+#ifndef BEJ_COL_H_
+#define BEJ_COL_H_
+
+/**
+ * @file bej_col.h
+ * @brief Columnar sink: batches of payloads decoded into typed columns.
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_COL_H_ */
@@ -19,32 +19,223 @@
 #include <stdlib.h>
 #include "bej.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 /* ---- helpers to emit JSON for primitive values ---- */
 
 static int decode_value_int(bej_jsonw* jw, bej_br* br, uint64_t L){
-    long long v=0;
-    for(uint64_t i=0;i<L;i++){
-        uint8_t b; if(!bej_br_u8(br,&b)) return 0;
-        v |= (long long)b << (8*i);
-    }
-    bej_jw_int(jw, v);
+    if(L > 8) return 0;
+    uint8_t b[8];
+    if(!bej_br_get(br, b, (size_t)L)) return 0;
+    uint64_t v=0;
+    for(size_t i=0;i<(size_t)L;i++) v |= (uint64_t)b[i] << (8*i);
+    bej_jw_int(jw, (long long)v);
     return 1;
 }
 
 static int decode_value_string(bej_jsonw* jw, bej_br* br, uint64_t L){
-    char* s=(char*)malloc((size_t)L+1); if(!s) return 0;
-    if(!bej_br_get(br, (uint8_t*)s, (size_t)L)){ free(s); return 0; }
-    s[L]=0;
-    /* strip trailing NUL(s) for neat JSON */
-    for(long i=(long)L-1; i>=0; --i){ if(s[i]==0) s[i]=0; else break; }
-    bej_jw_str(jw, s);
-    free(s);
+    /* Rendered straight from the input: stops at the first NUL (terminator/padding) */
+    if(L > bej_br_left(br)) return 0;
+    if(L <= br->n - br->p){
+        bej_jw_strn(jw, (const char*)br->d + br->p, (size_t)L);
+        br->p += (size_t)L;
+        return 1;
+    }
+    /* Value continues in the following segment(s): render piece by piece */
+    size_t k = (size_t)L; int open = 1;
+    bej_jw_write(jw, "\"", 1);
+    while(k){
+        const uint8_t* s; size_t c = bej_br_chunk(br, &s);
+        if(c > k) c = k;
+        if(open && bej_jw_esc(jw, (const char*)s, c) < c) open = 0;
+        br->p += c; k -= c;
+    }
+    bej_jw_write(jw, "\"", 1);
     return 1;
 }
 
+/* ---- bulk path for runs of Integer array elements ---- */
+
+#define INT_RUN_BATCH 256
+
+/* Little-endian value of w (<= 8) bytes; one masked 8-byte load when room allows */
+static uint64_t ld_le(const uint8_t* p, size_t w, size_t room){
+    uint64_t x = 0;
+    if(room >= 8){
+        memcpy(&x, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        x = __builtin_bswap64(x);
+#endif
+        return w >= 8 ? x : x & ((1ull << (8*w)) - 1);
+    }
+    for(size_t i=0;i<w;i++) x |= (uint64_t)p[i] << (8*i);
+    return x;
+}
+
+/* Same text as "%lld" */
+static size_t fmt_ll(char* o, long long v){
+    static const char d2[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char t[20]; size_t n = 0, k = 0;
+    unsigned long long u = v<0 ? 0ull-(unsigned long long)v : (unsigned long long)v;
+    while(u >= 100){ size_t i = (size_t)(u % 100)*2; u /= 100; t[n++] = d2[i+1]; t[n++] = d2[i]; }
+    if(u >= 10){ t[n++] = d2[u*2+1]; t[n++] = d2[u*2]; } else t[n++] = (char)('0' + u);
+    if(v < 0) o[k++] = '-';
+    while(n) o[k++] = t[--n];
+    return k;
+}
+
+/* Length of the "%lld" text */
+static size_t ll_width(long long v){
+    unsigned long long u = v<0 ? 0ull-(unsigned long long)v : (unsigned long long)v;
+    size_t w = v<0 ? 2 : 1;
+    while(u >= 10){ u /= 10; w++; }
+    return w;
+}
+
+/*
+ * Decode the run of Integer elements at the reader position: headers are
+ * validated in a tight scan that extracts the values into an int64 buffer,
+ * which is then formatted and written once per batch (a sizing pass only
+ * adds up the text lengths). The run ends at the first element of another
+ * format, with an unusual header, or not wholly inside the current segment;
+ * those go through the per-element path, which also reports malformed input.
+ * Returns the number of elements consumed.
+ *
+ * Integers only: a String element's cost is copying and escaping its bytes,
+ * which bej_jw_strn() already does a span at a time, so batching the headers
+ * of String runs would save little.
+ */
+static uint64_t decode_int_run(bej_jsonw* jw, bej_br* br, uint64_t left, int first){
+    const uint8_t* p = br->d + br->p;
+    size_t avail = br->n - br->p, off = 0;
+    long long v[INT_RUN_BATCH];
+    char txt[INT_RUN_BATCH*22];
+    uint64_t done = 0;
+    while(done < left){
+        size_t nb = 0;
+        while(nb < INT_RUN_BATCH && done + nb < left){
+            /* S (ignored) | F | L | V, all in this segment */
+            size_t q = off;
+            if(q >= avail || p[q] > 8) break;
+            q += 1 + (size_t)p[q];
+            if(q + 2 > avail || (p[q] >> 4) != BEJ_FMT_INT || p[q+1] > 8) break;
+            size_t lw = p[q+1]; q += 2;
+            if(q + lw > avail) break;
+            uint64_t L = ld_le(p + q, lw, avail - q);
+            q += lw;
+            if(L > 8 || q + L > avail) break;
+            v[nb++] = (long long)ld_le(p + q, (size_t)L, avail - q);
+            off = q + (size_t)L;
+        }
+        if(!nb) break;
+        size_t t = 0;
+        if(!jw->f && jw->sink==BEJ_JW_COUNT){
+            for(size_t i=0;i<nb;i++) t += ll_width(v[i]);
+            jw->len += t + 2*(nb - (first && !done));
+        }else{
+            for(size_t i=0;i<nb;i++){
+                if(!first || done || i){ txt[t++] = ','; txt[t++] = ' '; }
+                t += fmt_ll(txt + t, v[i]);
+            }
+            bej_jw_write(jw, txt, t);
+        }
+        done += nb;
+        if(nb < INT_RUN_BATCH) break;
+    }
+    br->p += off;
+    return done;
+}
+
+/* `"seq_<n>": ` key for members missing from the dictionary (no snprintf) */
+static size_t render_seq_key(char* out, uint64_t seq){
+    char dig[20]; size_t nd = 0;
+    do { dig[nd++] = (char)('0' + seq % 10); seq /= 10; } while(seq);
+    size_t n = 0;
+    memcpy(out, "\"seq_", 5); n = 5;
+    while(nd) out[n++] = dig[--nd];
+    memcpy(out+n, "\": ", 3);
+    return n+3;
+}
+
 /* ---- forward decl ---- */
 static int decode_value_set(bej_jsonw* jw, bej_br* br, const bej_dict* D, bej_cluster this_cluster);
 
+/**
+ * @brief Decode one tuple value (V) of a known format and emit it as JSON.
+ *
+ * @param jw JSON writer (a key, if any, has already been emitted).
+ * @param br Reader positioned at the start of the value.
+ * @param D  Parsed dictionary.
+ * @param de Dictionary entry describing the value (may be NULL if unknown).
+ * @param fmt Value format nibble (upper 4 bits of bejTupleF).
+ * @param L  Value length from the tuple header.
+ * @return 1 on success, 0 on malformed input.
+ */
+int bej_decode_value(bej_jsonw* jw, bej_br* br, const bej_dict* D, const bej_dict_entry* de, uint8_t fmt, uint64_t L){
+    if(fmt==BEJ_FMT_INT){
+        if(!decode_value_int(jw, br, L)) return 0;
+    }else if(fmt==BEJ_FMT_STRING){
+        if(!decode_value_string(jw, br, L)) return 0;
+    }else if(fmt==BEJ_FMT_SET){
+        /* Descend into child cluster if known */
+        if(!decode_value_set(jw, br, D, bej_dict_child_cluster(D, de))) return 0;
+    }else if(fmt==BEJ_FMT_ARRAY){
+        /* Arrays: count + element tuples (we print a flat JSON array of element values) */
+        uint64_t cnt; if(!bej_read_nnint(br,&cnt)) return 0;
+        bej_jw_begin_arr(jw);
+        for(uint64_t k=0;k<cnt;k++){
+            /* Runs of Integer elements are decoded in bulk */
+            uint64_t m = decode_int_run(jw, br, cnt-k, k==0);
+            if(m){ k += m-1; continue; }
+
+            /* Read element tuple header */
+            uint64_t Se; if(!bej_read_nnint(br,&Se)) return 0;
+            uint8_t  Fe; if(!bej_br_u8(br,&Fe)) return 0;
+            uint8_t  fmt_e = (uint8_t)(Fe>>4);
+            uint64_t Le; if(!bej_read_nnint(br,&Le)) return 0;
+
+            if(k>0) bej_jw_raw(jw, ", ");
+            if(fmt_e==BEJ_FMT_INT){
+                if(!decode_value_int(jw, br, Le)) return 0;
+            }else if(fmt_e==BEJ_FMT_STRING){
+                if(!decode_value_string(jw, br, Le)) return 0;
+            }else{
+                /* Unsupported element formats are skipped as null */
+                if(!bej_br_skip(br, Le)) return 0;
+                bej_jw_raw(jw, "null");
+            }
+        }
+        bej_jw_end_arr(jw);
+    }else if(fmt==BEJ_FMT_ENUM){
+        /* Map enum ordinal to its name via the entry's child cluster (render as JSON string) */
+        bej_br val = *br;
+        uint64_t opt_idx;
+        if(!bej_read_nnint(&val, &opt_idx)) return 0;
+        if(!bej_br_skip(br, L)) return 0;
+        const bej_dict_entry* opt = NULL;
+        if(de && de->child_off && de->child_cnt)
+            opt = bej_cluster_lookup_seq(D, bej_dict_child_cluster(D, de), opt_idx);
+        if(opt && opt->str){
+            bej_jw_write(jw, opt->str, opt->str_n);   /* pre-rendered */
+        }else{
+            const char* optname = (opt && opt->name_off) ? bej_dict_name_at(D, opt->name_off) : NULL;
+            bej_jw_str(jw, optname ? optname : "EnumOption");
+        }
+    }else{
+        /* Unsupported formats: skip payload and emit null */
+        if(!bej_br_skip(br, L)) return 0;
+        bej_jw_raw(jw, "null");
+    }
+    return 1;
+}
+
 /**
  * @brief Decode a Set value: a count followed by that many tuples; emit a JSON object.
  *
@@ -63,7 +254,7 @@ static int decode_value_set(bej_jsonw* jw, bej_br* br, const bej_dict* D, bej_cl
         /* Sequence (nnint). LSB=1 indicates Annotation (skipped). */
         uint64_t S; if(!bej_read_nnint(br,&S)) return 0;
         int is_annotation = (S & 1u) ? 1: 0;
-        uint16_t seq = (uint16_t)(S >> 1);
+        uint64_t seq = S >> 1;
 
         /* Tuple format and payload length */
         uint8_t F; if(!bej_br_u8(br,&F)) return 0;
@@ -72,81 +263,55 @@ static int decode_value_set(bej_jsonw* jw, bej_br* br, const bej_dict* D, bej_cl
 
         if(is_annotation){
             /* Skip annotation payload completely */
-            if(bej_br_left(br) < (int)L) return 0;
-            br->p += (size_t)L;
+            if(!bej_br_skip(br, L)) return 0;
             continue;
         }
 
-        /* Resolve property name within this cluster */
+        /* Resolve property name within this cluster and emit its key */
         const bej_dict_entry* de = bej_cluster_lookup_seq(D, this_cluster, seq);
-        const char* name = (de && de->name_off)? bej_dict_name_at(D, de->name_off): NULL;
-        char tmp[32]; if(!name){ snprintf(tmp,sizeof(tmp),"seq_%u", (unsigned)seq); name = tmp; }
-
-        /* Emit key and decode value by format */
-        bej_jw_key(jw, name);
-        if(fmt==BEJ_FMT_INT){
-            if(!decode_value_int(jw, br, L)) return 0;
-        }else if(fmt==BEJ_FMT_STRING){
-            if(!decode_value_string(jw, br, L)) return 0;
-        }else if(fmt==BEJ_FMT_SET){
-            /* Descend into child cluster if known */
-            bej_cluster childc = (bej_cluster){0,0};
-            if(de && de->child_off){
-                childc.start_idx = (uint32_t)(((size_t)de->child_off - D->entries_ofs)/10);
-                childc.count     = de->child_cnt;
-            }
-            if(!decode_value_set(jw, br, D, childc)) return 0;
-        }else if(fmt==BEJ_FMT_ARRAY){
-            /* Arrays: count + element tuples (we print a flat JSON array of element values) */
-            uint64_t cnt; if(!bej_read_nnint(br,&cnt)) return 0;
-            bej_jw_begin_arr(jw);
-            for(uint64_t k=0;k<cnt;k++){
-                /* Read element tuple header */
-                uint64_t Se; if(!bej_read_nnint(br,&Se)) return 0;
-                uint8_t  Fe; if(!bej_br_u8(br,&Fe)) return 0;
-                uint8_t  fmt_e = (uint8_t)(Fe>>4);
-                uint64_t Le; if(!bej_read_nnint(br,&Le)) return 0;
-
-                if(k>0) fputs(", ", jw->f);
-                if(fmt_e==BEJ_FMT_INT){
-                    if(!decode_value_int(jw, br, Le)) return 0;
-                }else if(fmt_e==BEJ_FMT_STRING){
-                    if(!decode_value_string(jw, br, Le)) return 0;
-                }else{
-                    /* Unsupported element formats are skipped as null */
-                    if(bej_br_left(br) < (int)Le) return 0; br->p += (size_t)Le; fputs("null", jw->f);
-                }
-            }
-            bej_jw_end_arr(jw);
-        }else if(fmt==BEJ_FMT_ENUM){
-            /* Map enum ordinal to its name via the entry's child cluster (render as JSON string) */
-            bej_br val = *br;
-            uint64_t opt_idx;
-            if(!bej_read_nnint(&val, &opt_idx)) return 0;
-            if(bej_br_left(br) < (int)L) return 0; br->p += (size_t)L;
-            const char* optname = "EnumOption";
-            if(de && de->child_off && de->child_cnt){
-                bej_cluster enumc; enumc.start_idx = (uint32_t)(((size_t)de->child_off - D->entries_ofs)/10);
-                enumc.count = de->child_cnt;
-                const bej_dict_entry* opt = bej_cluster_lookup_seq(D, enumc, (uint16_t)opt_idx);
-                if(opt && opt->name_off) optname = bej_dict_name_at(D, opt->name_off);
-            }
-            bej_jw_str(jw, optname);
+        if(de && de->key){
+            bej_jw_key_lit(jw, de->key, de->key_n);
+        }else if(!de){
+            char tmp[40]; bej_jw_key_lit(jw, tmp, render_seq_key(tmp, seq));
         }else{
-            /* Unsupported formats: skip payload and emit null */
-            if(bej_br_left(br) < (int)L) return 0;
-            br->p += (size_t)L;
-            fputs("null", jw->f);
+            const char* name = de->name_off ? bej_dict_name_at(D, de->name_off) : NULL;
+            char tmp[32]; if(!name){ snprintf(tmp,sizeof(tmp),"seq_%llu", (unsigned long long)seq); name = tmp; }
+            bej_jw_key(jw, name);
         }
+
+        /* Decode value by format */
+        if(!bej_decode_value(jw, br, D, de, fmt, L)) return 0;
     }
     bej_jw_end_obj(jw);
     return 1;
 }
 
+/* bejEncoding header + top-level Set, from any reader */
+static int decode_stream(bej_jsonw* jw, bej_br* br, const bej_dict* D){
+    /* bejEncoding header: version(4 LE), flags(2 LE), schemaClass(1) */
+    uint8_t hdr[7];
+    if(!bej_br_get(br, hdr, sizeof(hdr))) return 0;
+
+    /* Root cluster (children of root entry 0) */
+    bej_cluster rootc = bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL);
+
+    /* Parse and require a top-level Set */
+    uint64_t S; if(!bej_read_nnint(br, &S)) return 0;
+    uint8_t F; if(!bej_br_u8(br,&F)) return 0;
+    uint8_t fmt = (uint8_t)(F>>4);
+    uint64_t L; if(!bej_read_nnint(br, &L)) return 0;
+    if(fmt != BEJ_FMT_SET) return 0;
+
+    /* Decode the top-level Set (decode_value_set writes the object braces) */
+    if(!decode_value_set(jw, br, D, rootc)) return 0;
+    bej_jw_raw(jw, "\n");
+    return !jw->oom;
+}
+
 /**
- * @brief Decode a complete BEJ stream (bejEncoding + top-level tuple) and emit JSON.
+ * @brief Decode a complete BEJ stream (bejEncoding + top-level tuple) into a JSON writer.
  *
- * @param out FILE* for output JSON.
+ * @param jw JSON writer (file or memory sink).
  * @param bej Pointer to start of BEJ-encoded data.
  * @param bej_n Length of the BEJ data.
  * @param D Parsed schema dictionary used for names and clusters.
@@ -156,35 +321,153 @@ static int decode_value_set(bej_jsonw* jw, bej_br* br, const bej_dict* D, bej_cl
  *       `version(4 LE)`, `flags(2 LE)`, `schemaClass(1)`, followed by a tuple.
  *       The top-level tuple is expected to be a **Set** whose members are emitted at JSON root.
  */
-int bej_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D){
-    if(!out || !bej || !D) return 0;
-
+int bej_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n, const bej_dict* D){
+    if(!jw || !bej || !D) return 0;
     bej_br br; bej_br_init(&br, bej, bej_n);
+    return decode_stream(jw, &br, D);
+}
+
+/**
+ * @brief Decode a complete BEJ stream (bejEncoding + top-level tuple) and emit JSON.
+ *
+ * @param out FILE* for output JSON.
+ * @param bej Pointer to start of BEJ-encoded data.
+ * @param bej_n Length of the BEJ data.
+ * @param D Parsed schema dictionary used for names and clusters.
+ * @return 1 on success, 0 on malformed input.
+ */
+int bej_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n, const bej_dict* D){
+    if(!out) return 0;
     bej_jsonw jw; bej_jw_init(&jw, out);
+    return bej_decode_to_jsonw(&jw, bej, bej_n, D);
+}
 
-    /* bejEncoding header */
-    if(bej_br_left(&br) < 7) return 0;
-    uint32_t ver; memcpy(&ver, br.d+br.p, 4); br.p+=4;
-    uint16_t flags; memcpy(&flags, br.d+br.p, 2); br.p+=2;
-    uint8_t schemaClass; if(!bej_br_u8(&br, &schemaClass)) return 0;
-    (void)ver; (void)flags; (void)schemaClass;
+/**
+ * @brief Decode a complete BEJ stream into a newly allocated JSON text.
+ *
+ * @param bej Pointer to start of BEJ-encoded data.
+ * @param bej_n Length of the BEJ data.
+ * @param D Parsed schema dictionary.
+ * @param out Output: heap buffer with the JSON text (not NUL-terminated); free() it.
+ * @param out_n Output: length of @p out.
+ * @return 1 on success, 0 on malformed input or allocation failure.
+ */
+int bej_decode_to_mem(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n){
+    if(!out || !out_n) return 0;
+    *out=NULL; *out_n=0;
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    if(!bej_decode_to_jsonw(&jw, bej, bej_n, D)){ free(jw.buf); return 0; }
+    *out=jw.buf; *out_n=jw.len;
+    return 1;
+}
 
-    /* Root cluster (children of root entry 0) */
-    bej_cluster rootc = (bej_cluster){0,0};
-    if(D->n>0 && D->ent[0].child_off){
-        rootc.start_idx = (uint32_t)(((size_t)D->ent[0].child_off - D->entries_ofs)/10);
-        rootc.count     = D->ent[0].child_cnt;
-    }
+/**
+ * @brief Decode a BEJ stream that arrives as a list of segments.
+ *
+ * The segments are read in place as one stream (no coalescing copy); tuple
+ * headers, nnints and values may straddle segment boundaries.
+ *
+ * @param jw JSON writer (file or memory sink).
+ * @param seg Segments in stream order.
+ * @param nseg Number of segments.
+ * @param D Parsed schema dictionary.
+ * @return 1 on success, 0 on malformed input.
+ */
+int bej_decode_iov_to_jsonw(bej_jsonw* jw, const bej_iov* seg, size_t nseg, const bej_dict* D){
+    if(!jw || (!seg && nseg) || !D) return 0;
+    bej_br br; bej_br_init_iov(&br, seg, nseg);
+    return decode_stream(jw, &br, D);
+}
 
-    /* Parse and require a top-level Set */
-    uint64_t S; if(!bej_read_nnint(&br, &S)) return 0;
-    uint8_t F; if(!bej_br_u8(&br,&F)) return 0;
-    uint8_t fmt = (uint8_t)(F>>4);
-    uint64_t L; if(!bej_read_nnint(&br, &L)) return 0;
-    if(fmt != BEJ_FMT_SET) return 0;
+/**
+ * @brief Decode a segmented BEJ stream and emit JSON to a file.
+ * @see bej_decode_iov_to_jsonw()
+ */
+int bej_decode_iov_to_json(FILE* out, const bej_iov* seg, size_t nseg, const bej_dict* D){
+    if(!out) return 0;
+    bej_jsonw jw; bej_jw_init(&jw, out);
+    return bej_decode_iov_to_jsonw(&jw, seg, nseg, D);
+}
 
-    /* Decode the top-level Set (decode_value_set writes the object braces) */
-    if(!decode_value_set(&jw, &br, D, rootc)) return 0;
-    fputc('\n', jw.f);
+/**
+ * @brief Sizing pass: compute the exact JSON length of a BEJ stream.
+ *
+ * Walks the tuples and the dictionary like a decode, but through a
+ * @ref BEJ_JW_COUNT writer, so nothing is formatted into memory. The count
+ * includes escapes, indentation and the trailing newline.
+ *
+ * @param bej Pointer to start of BEJ-encoded data.
+ * @param bej_n Length of the BEJ data.
+ * @param D Parsed schema dictionary.
+ * @param out_n Output: number of bytes bej_decode_to_mem() would produce.
+ * @return 1 on success, 0 on malformed input.
+ */
+int bej_decode_size(const uint8_t* bej, size_t bej_n, const bej_dict* D, size_t* out_n){
+    if(!out_n) return 0;
+    *out_n=0;
+    bej_jsonw jw; bej_jw_init_count(&jw);
+    if(!bej_decode_to_jsonw(&jw, bej, bej_n, D)) return 0;
+    *out_n=jw.len;
     return 1;
 }
+
+/* Render pass into out[0..out_n), written without bounds checks: out_n must be
+ * what bej_decode_size() measured for this same bej / D pair (both callers
+ * below pair the two themselves). */
+static int decode_to_fixed(const uint8_t* bej, size_t bej_n, const bej_dict* D, char* out, size_t out_n){
+    bej_jsonw jw; bej_jw_init(&jw, NULL);
+    jw.buf=out; jw.cap=out_n; jw.sink=BEJ_JW_FIXED;
+    return bej_decode_to_jsonw(&jw, bej, bej_n, D) && jw.len==out_n;
+}
+
+/**
+ * @brief Like bej_decode_to_mem(), but sizes first and allocates once.
+ *
+ * Trades a second walk over the input for the growth reallocations (and
+ * their copies) of the growable sink; see the "exact" benchmark.
+ * @return 1 on success, 0 on malformed input or allocation failure.
+ */
+int bej_decode_to_mem_exact(const uint8_t* bej, size_t bej_n, const bej_dict* D, char** out, size_t* out_n){
+    if(!out || !out_n) return 0;
+    *out=NULL; *out_n=0;
+    size_t n; if(!bej_decode_size(bej, bej_n, D, &n)) return 0;
+    char* b = (char*)malloc(n ? n : 1);
+    if(!b) return 0;
+    if(!decode_to_fixed(bej, bej_n, D, b, n)){ free(b); return 0; }
+    *out=b; *out_n=n;
+    return 1;
+}
+
+/**
+ * @brief Decode into a file of exactly the output size.
+ *
+ * The file is created at its final length and rendered through a shared
+ * mapping; without mmap (Windows) it falls back to bej_decode_to_mem_exact()
+ * and one fwrite(). On failure the file may be left partially written.
+ *
+ * @param path Output file (created or truncated).
+ * @return 1 on success, 0 on malformed input or I/O failure.
+ */
+int bej_decode_to_path_exact(const char* path, const uint8_t* bej, size_t bej_n, const bej_dict* D){
+    if(!path) return 0;
+#ifndef _WIN32
+    size_t n; if(!bej_decode_size(bej, bej_n, D, &n)) return 0;
+    int fd = open(path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if(fd < 0) return 0;
+    if(n == 0){ close(fd); return 1; }
+    if(ftruncate(fd, (off_t)n) != 0){ close(fd); return 0; }
+    void* m = mmap(NULL, n, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) return 0;
+    int ok = decode_to_fixed(bej, bej_n, D, (char*)m, n);
+    return munmap(m, n)==0 && ok;
+#else
+    char* b; size_t n;
+    if(!bej_decode_to_mem_exact(bej, bej_n, D, &b, &n)) return 0;
+    FILE* f = fopen(path, "wb");
+    int ok = f && fwrite(b,1,n,f)==n;
+    if(f && fclose(f)!=0) ok = 0;
+    free(b);
+    return ok;
+#endif
+}
@@ -0,0 +1,280 @@
+/**
+ * @file bej_delta.c
+ * @brief Structural delta between two BEJ payloads of the same resource.
+ *
+ * Both payloads are walked side by side. Set members are matched by their
+ * sequence number; a member whose format, length and value bytes are identical
+ * in both payloads is skipped without being decoded. Only changed members are
+ * decoded and emitted, either as a JSON Merge Patch (RFC 7386) or as a
+ * JSON Patch (RFC 6902) operation list.
+ *
+ * @note Arrays are compared as a whole: a changed array is replaced entirely.
+ * @note In a merge patch `null` removes a member, so a merge delta fails if a
+ *       changed value (or a member of a changed Set) has a format the decoder
+ *       renders as null (Null, Boolean, Real, ...). JSON Patch has no such limit.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "bej.h"
+
+/** One non-annotation member of a Set, as located in its payload. */
+typedef struct {
+    uint64_t S;      /**< Raw sequence nnint (seq << 1). */
+    uint8_t  fmt;    /**< Value format nibble. */
+    size_t   v_off;  /**< Absolute offset of the value bytes. */
+    uint64_t L;      /**< Value length. */
+} delta_member;
+
+typedef struct {
+    const uint8_t* d;
+    size_t         n;
+    delta_member*  m;
+    size_t         cnt;
+} delta_set;
+
+typedef struct {
+    bej_jsonw      jw;
+    const bej_dict* D;
+    const uint8_t* cur;
+    size_t         cur_n;
+    int            mode;
+    size_t         ops;    /**< JSON Patch operations emitted so far. */
+    char*          path;   /**< JSON Pointer of the Set being compared. */
+    size_t         path_n;
+    size_t         path_cap;
+} delta_ctx;
+
+/* Collect the members of the Set value at [pos, pos+L) without decoding them. */
+static int scan_set(delta_set* s, const uint8_t* d, size_t n, size_t pos, uint64_t L){
+    s->d=d; s->n=n; s->m=NULL; s->cnt=0;
+    bej_br br; bej_br_init(&br, d, pos + (size_t)L);
+    br.p = pos;
+    uint64_t count; if(!bej_read_nnint(&br,&count)) return 0;
+    if(count > bej_br_left(&br)) return 0; /* every tuple needs at least one byte */
+    s->m = (delta_member*)malloc((size_t)(count ? count : 1) * sizeof(delta_member));
+    if(!s->m) return 0;
+    for(uint64_t i=0;i<count;i++){
+        uint64_t S; if(!bej_read_nnint(&br,&S)) return 0;
+        uint8_t F;  if(!bej_br_u8(&br,&F)) return 0;
+        uint64_t Lm; if(!bej_read_nnint(&br,&Lm)) return 0;
+        if(!(S & 1u)){
+            delta_member* m = &s->m[s->cnt++];
+            m->S=S; m->fmt=(uint8_t)(F>>4); m->v_off=br.p; m->L=Lm;
+        }
+        if(!bej_br_skip(&br, Lm)) return 0;
+    }
+    return 1;
+}
+
+static int same_value(const delta_set* a, const delta_member* ma, const delta_set* b, const delta_member* mb){
+    return ma->fmt==mb->fmt && ma->L==mb->L && memcmp(a->d+ma->v_off, b->d+mb->v_off, (size_t)ma->L)==0;
+}
+
+static const char* member_name(const bej_dict* D, const bej_dict_entry* de, uint64_t S, char* tmp, size_t tmp_n){
+    const char* name = (de && de->name_off)? bej_dict_name_at(D, de->name_off): NULL;
+    if(!name){ snprintf(tmp,tmp_n,"seq_%llu", (unsigned long long)(S>>1)); name = tmp; }
+    return name;
+}
+
+/* Append "/<name>" to the current JSON Pointer (RFC 6901 escaping). */
+static int path_push(delta_ctx* c, const char* name){
+    size_t need = c->path_n + 2*strlen(name) + 2;
+    if(need > c->path_cap){
+        size_t cap = c->path_cap ? c->path_cap : 64;
+        while(cap < need) cap *= 2;
+        char* p = (char*)realloc(c->path, cap); if(!p) return 0;
+        c->path=p; c->path_cap=cap;
+    }
+    c->path[c->path_n++]='/';
+    for(const char* q=name;*q;q++){
+        if(*q=='~'){ c->path[c->path_n++]='~'; c->path[c->path_n++]='0'; }
+        else if(*q=='/'){ c->path[c->path_n++]='~'; c->path[c->path_n++]='1'; }
+        else c->path[c->path_n++]=*q;
+    }
+    c->path[c->path_n]=0;
+    return 1;
+}
+
+static void emit_op(delta_ctx* c, const char* op){
+    if(c->ops++) bej_jw_raw(&c->jw, ", ");
+    bej_jw_begin_obj(&c->jw);
+    bej_jw_key(&c->jw, "op");   bej_jw_str(&c->jw, op);
+    bej_jw_key(&c->jw, "path"); bej_jw_str(&c->jw, c->path);
+}
+
+/* Decode one member of the current payload as a JSON value. */
+static int emit_value(delta_ctx* c, const bej_dict_entry* de, const delta_member* m){
+    bej_br br; bej_br_init(&br, c->cur, c->cur_n);
+    br.p = m->v_off;
+    return bej_decode_value(&c->jw, &br, c->D, de, m->fmt, m->L);
+}
+
+/* Formats the decoder renders as a value; every other one comes out as null */
+static int renders_value(uint8_t fmt){
+    return fmt==BEJ_FMT_SET || fmt==BEJ_FMT_ARRAY || fmt==BEJ_FMT_INT || fmt==BEJ_FMT_ENUM || fmt==BEJ_FMT_STRING;
+}
+
+/* Merge mode: the member renders without a null in its object tree (Array elements may be null). */
+static int merge_safe(const delta_set* s, const delta_member* m){
+    if(!renders_value(m->fmt)) return 0;
+    if(m->fmt != BEJ_FMT_SET) return 1;
+    delta_set in;
+    int ok = scan_set(&in, s->d, s->n, m->v_off, m->L);
+    for(size_t i=0;ok && i<in.cnt;i++) ok = merge_safe(&in, &in.m[i]);
+    free(in.m);
+    return ok;
+}
+
+static int diff_set(delta_ctx* c, const delta_set* prev, const delta_set* cur, bej_cluster cl);
+
+/* Emit the change for one member present in @p cur (and possibly in @p prev). */
+static int diff_member(delta_ctx* c, const delta_set* prev, const delta_member* pm,
+                       const delta_set* cur, const delta_member* cm, bej_cluster cl){
+    const bej_dict_entry* de = bej_cluster_lookup_seq(c->D, cl, cm->S>>1);
+    char tmp[32]; const char* name = member_name(c->D, de, cm->S, tmp, sizeof(tmp));
+
+    if(pm && pm->fmt==BEJ_FMT_SET && cm->fmt==BEJ_FMT_SET){
+        /* Both Sets: recurse so that only the changed members are emitted */
+        delta_set ps, cs; int ok;
+        if(!scan_set(&ps, prev->d, prev->n, pm->v_off, pm->L)){ free(ps.m); return 0; }
+        if(!scan_set(&cs, cur->d, cur->n, cm->v_off, cm->L)){ free(ps.m); free(cs.m); return 0; }
+        if(c->mode==BEJ_PATCH_MERGE){
+            bej_jw_key(&c->jw, name);
+            ok = diff_set(c, &ps, &cs, bej_dict_child_cluster(c->D, de));
+        }else{
+            size_t saved = c->path_n;
+            ok = path_push(c, name) && diff_set(c, &ps, &cs, bej_dict_child_cluster(c->D, de));
+            c->path_n = saved; if(c->path) c->path[saved]=0;
+        }
+        free(ps.m); free(cs.m);
+        return ok;
+    }
+
+    if(c->mode==BEJ_PATCH_MERGE){
+        if(!merge_safe(cur, cm)) return 0;
+        bej_jw_key(&c->jw, name);
+        return emit_value(c, de, cm);
+    }
+    size_t saved = c->path_n;
+    if(!path_push(c, name)) return 0;
+    emit_op(c, pm ? "replace" : "add");
+    bej_jw_key(&c->jw, "value");
+    int ok = emit_value(c, de, cm);
+    bej_jw_end_obj(&c->jw);
+    c->path_n = saved; c->path[saved]=0;
+    return ok;
+}
+
+/**
+ * Compare two scanned Sets sharing cluster @p cl. In merge mode this writes a
+ * JSON object holding only the changed members; in patch mode it appends
+ * operations to the enclosing array.
+ */
+static int diff_set(delta_ctx* c, const delta_set* prev, const delta_set* cur, bej_cluster cl){
+    char* matched = (char*)calloc(prev->cnt ? prev->cnt : 1, 1);
+    if(!matched) return 0;
+    if(c->mode==BEJ_PATCH_MERGE) bej_jw_begin_obj(&c->jw);
+
+    for(size_t i=0;i<cur->cnt;i++){
+        const delta_member* cm = &cur->m[i];
+        /* Members usually keep their position between polls; fall back to a scan */
+        size_t j = prev->cnt;
+        if(i < prev->cnt && prev->m[i].S==cm->S) j = i;
+        else for(size_t k=0;k<prev->cnt;k++) if(!matched[k] && prev->m[k].S==cm->S){ j=k; break; }
+
+        const delta_member* pm = NULL;
+        if(j < prev->cnt){
+            matched[j] = 1; pm = &prev->m[j];
+            if(same_value(prev, pm, cur, cm)) continue; /* identical subtree: skip */
+        }
+        if(!diff_member(c, prev, pm, cur, cm, cl)){ free(matched); return 0; }
+    }
+
+    /* Members that disappeared */
+    for(size_t k=0;k<prev->cnt;k++){
+        if(matched[k]) continue;
+        const bej_dict_entry* de = bej_cluster_lookup_seq(c->D, cl, prev->m[k].S>>1);
+        char tmp[32]; const char* name = member_name(c->D, de, prev->m[k].S, tmp, sizeof(tmp));
+        if(c->mode==BEJ_PATCH_MERGE){
+            bej_jw_key(&c->jw, name); bej_jw_raw(&c->jw, "null");
+        }else{
+            size_t saved = c->path_n;
+            if(!path_push(c, name)){ free(matched); return 0; }
+            emit_op(c, "remove");
+            bej_jw_end_obj(&c->jw);
+            c->path_n = saved; c->path[saved]=0;
+        }
+    }
+
+    if(c->mode==BEJ_PATCH_MERGE) bej_jw_end_obj(&c->jw);
+    free(matched);
+    return 1;
+}
+
+/* Skip the bejEncoding header and locate the root Set value. */
+static int root_set(const uint8_t* d, size_t n, size_t* v_off, uint64_t* L){
+    bej_br br; bej_br_init(&br, d, n);
+    if(!bej_br_seek(&br, 7)) return 0;
+    uint64_t S; if(!bej_read_nnint(&br,&S)) return 0;
+    uint8_t F;  if(!bej_br_u8(&br,&F)) return 0;
+    if((F>>4) != BEJ_FMT_SET) return 0;
+    if(!bej_read_nnint(&br,L)) return 0;
+    if(*L > bej_br_left(&br)) return 0;
+    *v_off = br.p;
+    return 1;
+}
+
+/**
+ * @brief Emit the changes between two BEJ payloads of the same resource.
+ *
+ * @param out FILE* for the patch document.
+ * @param prev Previous BEJ payload (bejEncoding header + root Set).
+ * @param prev_n Length of @p prev.
+ * @param cur Current BEJ payload.
+ * @param cur_n Length of @p cur.
+ * @param D Schema dictionary shared by both payloads.
+ * @param mode @ref BEJ_PATCH_MERGE or @ref BEJ_PATCH_JSON.
+ * The patch is rendered in memory and written to @p out only on success, so
+ * a failed delta leaves @p out untouched.
+ *
+ * @return 1 on success, 0 on malformed input, allocation or write failure or,
+ *         in merge mode, if a changed value would render as null (see the
+ *         file notes).
+ *
+ * @note Values are rendered exactly as @ref bej_decode_to_json would render them.
+ */
+int bej_delta_to_json(FILE* out, const uint8_t* prev, size_t prev_n,
+                      const uint8_t* cur, size_t cur_n, const bej_dict* D, int mode){
+    if(!out || !prev || !cur || !D) return 0;
+    if(mode!=BEJ_PATCH_MERGE && mode!=BEJ_PATCH_JSON) return 0;
+
+    size_t pv, cv; uint64_t pL, cL;
+    if(!root_set(prev, prev_n, &pv, &pL) || !root_set(cur, cur_n, &cv, &cL)) return 0;
+
+    delta_ctx c; memset(&c, 0, sizeof(c));
+    bej_jw_init_mem(&c.jw);
+    c.D=D; c.cur=cur; c.cur_n=cur_n; c.mode=mode;
+
+    int ok = 1;
+    if(pL==cL && memcmp(prev+pv, cur+cv, (size_t)cL)==0){
+        /* Nothing changed: empty patch */
+        bej_jw_raw(&c.jw, mode==BEJ_PATCH_MERGE ? "{}" : "[]");
+    }else{
+        delta_set ps, cs;
+        ok = scan_set(&ps, prev, prev_n, pv, pL);
+        ok = scan_set(&cs, cur, cur_n, cv, cL) && ok;
+        if(ok){
+            bej_cluster rootc = bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL);
+            if(mode==BEJ_PATCH_JSON) bej_jw_begin_arr(&c.jw);
+            ok = diff_set(&c, &ps, &cs, rootc);
+            if(mode==BEJ_PATCH_JSON) bej_jw_end_arr(&c.jw);
+        }
+        free(ps.m); free(cs.m);
+    }
+    free(c.path);
+    bej_jw_raw(&c.jw, "\n");
+    ok = ok && !c.jw.oom && fwrite(c.jw.buf, 1, c.jw.len, out)==c.jw.len;
+    free(c.jw.buf);
+    return ok;
+}
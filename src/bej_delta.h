@@ -0,0 +1,11 @@
+#ifndef BEJ_DELTA_H_
+#define BEJ_DELTA_H_
+
+/**
+ * @file bej_delta.h
+ * @brief Structural delta between two BEJ payloads (JSON Merge Patch / JSON Patch).
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_DELTA_H_ */
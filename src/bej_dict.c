@@ -3,53 +3,136 @@
  * @brief Redfish schema dictionary (DSP0218 Table 31) parser.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bej.h"
 
-/**
- * @brief Parse a Redfish schema dictionary binary (Table 31).
- *
- * @param d Pointer to dictionary blob.
- * @param n Size of dictionary blob.
- * @param out Output parsed dictionary.
- * @return 1 on success, 0 on failure (format mismatch or truncation).
+static uint16_t rd16(const uint8_t* p){ return (uint16_t)(p[0] | (p[1]<<8)); }
+static uint32_t rd32(const uint8_t* p){ return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+
+/* Rendered size of a name as a JSON key body / string body (quotes and separators excluded) */
+static size_t esc_len(const char* s, int nl){
+    size_t n = 0;
+    for(;*s;s++) n += (*s=='"' || *s=='\\' || (nl && *s=='\n')) ? 2 : 1;
+    return n;
+}
+
+static char* esc_copy(char* q, const char* s, int nl){
+    for(;*s;s++){
+        if(nl && *s=='\n'){ *q++='\\'; *q++='n'; }
+        else { if(*s=='"' || *s=='\\') *q++='\\'; *q++=*s; }
+    }
+    return q;
+}
+
+/*
+ * Pre-render every entry once: the quoted, escaped key with its ": "
+ * separator (what bej_jw_key() writes after the indentation) and the quoted
+ * string bej_jw_str() writes for an enum option. Keys then cost one copy.
+ * Dictionaries whose names would blow up the pool (overlapping name offsets)
+ * are left unrendered and take the per-byte path.
  */
-int bej_dict_load(const uint8_t* d, size_t n, bej_dict* out){
+static void dict_render(bej_dict* D){
+    size_t total = 0, budget = 4*D->blob_n + 64*D->n + 4096;
+    for(size_t i=0;i<D->n;i++){
+        const char* nm = bej_dict_name_at(D, D->ent[i].name_off);
+        total += nm ? 3 + esc_len(nm,0) + 2 + esc_len(nm,1) + 3 : 32;
+        if(total > budget) return;
+    }
+    char* pool = (char*)malloc(total ? total : 1);
+    if(!pool) return;
+    char* q = pool;
+    for(size_t i=0;i<D->n;i++){
+        bej_dict_entry* e = &D->ent[i];
+        const char* nm = bej_dict_name_at(D, e->name_off);
+        e->key = q;
+        if(nm){
+            *q++='"'; q = esc_copy(q, nm, 0); memcpy(q, "\": ", 3); q += 3;
+            e->key_n = (size_t)(q - e->key);
+            e->str = q;
+            *q++='"'; q = esc_copy(q, nm, 1); *q++='"';
+            e->str_n = (size_t)(q - e->str);
+        }else{
+            q += snprintf(q, 32, "\"seq_%u\": ", (unsigned)e->seq);
+            e->key_n = (size_t)(q - e->key);
+        }
+    }
+    D->render = pool;
+}
+
+static int dict_load(const uint8_t* d, size_t n, bej_dict* out, int allow_wide){
     if(!d || !out) return 0;
     if(n < 12) return 0;
     size_t p=0;
     uint8_t verTag = d[p++];           /* ignored here */
-    uint8_t flags  = d[p++];           /* ignored here */
-    uint16_t entryCount = (uint16_t)(d[p] | (d[p+1]<<8)); p+=2;
-    (void)flags; (void)verTag;
-    uint32_t schemaVer = (uint32_t)(d[p] | (d[p+1]<<8) | (d[p+2]<<16) | (d[p+3]<<24)); p+=4;
-    uint32_t dictSize  = (uint32_t)(d[p] | (d[p+1]<<8) | (d[p+2]<<16) | (d[p+3]<<24)); p+=4;
+    uint8_t flags  = d[p++];
+    size_t entryCount = rd16(d+p); p+=2;
+    (void)verTag;
+    uint32_t schemaVer = rd32(d+p); p+=4;
+    uint32_t dictSize  = rd32(d+p); p+=4;
     (void)schemaVer; (void)dictSize;
-    if(n < p + entryCount*10) return 0;
+    int wide = (flags & BEJ_DICT_FLAG_LOCAL_WIDE) != 0;
+    if(wide && !allow_wide) return 0;
+    size_t esz = wide ? BEJ_DICT_WIDE_ENTRY_N : BEJ_DICT_ENTRY_N;
+    if((n - p) / esz < entryCount) return 0;
 
-    bej_dict_entry* a = (bej_dict_entry*)calloc(entryCount, sizeof(bej_dict_entry));
+    bej_dict_entry* a = (bej_dict_entry*)calloc(entryCount ? entryCount : 1, sizeof(bej_dict_entry));
     if(!a) return 0;
     size_t entries_ofs = p;
 
-    for(uint16_t i=0;i<entryCount;i++){
-        a[i].fmt       = d[p+0];
-        a[i].seq       = (uint16_t)(d[p+1] | (d[p+2]<<8));
-        a[i].child_off = (uint16_t)(d[p+3] | (d[p+4]<<8));
-        a[i].child_cnt = (uint16_t)(d[p+5] | (d[p+6]<<8));
-        a[i].name_len  = d[p+7];
-        a[i].name_off  = (uint16_t)(d[p+8] | (d[p+9]<<8));
-        p += 10;
+    for(size_t i=0;i<entryCount;i++){
+        a[i].fmt = d[p+0];
+        a[i].seq = rd16(d+p+1);
+        if(wide){
+            a[i].child_off = rd32(d+p+3);
+            a[i].child_cnt = rd16(d+p+7);
+            a[i].name_len  = d[p+9];
+            a[i].name_off  = rd32(d+p+10);
+        }else{
+            a[i].child_off = rd16(d+p+3);
+            a[i].child_cnt = rd16(d+p+5);
+            a[i].name_len  = d[p+7];
+            a[i].name_off  = rd16(d+p+8);
+        }
+        p += esz;
     }
 
     size_t names_ofs = p;
-    out->ent=a; out->n=entryCount; out->entries_ofs=entries_ofs; out->names_ofs=names_ofs; out->blob=d; out->blob_n=n;
+    out->ent=a; out->n=entryCount; out->ent_size=esz; out->entries_ofs=entries_ofs; out->names_ofs=names_ofs; out->blob=d; out->blob_n=n;
+    out->id = bej_hash64(d, n, 0);
+    out->render = NULL;
+    dict_render(out);
     return 1;
 }
 
-/** Free dictionary (entries are heap-allocated; name strings point into blob). */
+/**
+ * @brief Parse a Redfish schema dictionary binary (Table 31).
+ *
+ * For externally supplied dictionaries: a header with the reserved
+ * @ref BEJ_DICT_FLAG_LOCAL_WIDE bit set is rejected. Entry keys and names are
+ * pre-rendered as JSON (@ref bej_dict_entry::key, @ref bej_dict_entry::str).
+ *
+ * @param d Pointer to dictionary blob.
+ * @param n Size of dictionary blob.
+ * @param out Output parsed dictionary.
+ * @return 1 on success, 0 on failure (format mismatch or truncation).
+ */
+int bej_dict_load(const uint8_t* d, size_t n, bej_dict* out){ return dict_load(d, n, out, 0); }
+
+/**
+ * @brief Like bej_dict_load(), but also accepts the local wide-entry layout.
+ *
+ * Only for dictionaries produced by this project's own tooling (e.g. the
+ * benchmark generator past 64 KiB), never for ones received from elsewhere.
+ */
+int bej_dict_load_local(const uint8_t* d, size_t n, bej_dict* out){ return dict_load(d, n, out, 1); }
+
+/** Free dictionary (entries and rendered keys are heap-allocated; name strings point into blob). */
 void bej_dict_free(bej_dict* D){
     if(!D) return;
-    free(D->ent); D->ent=NULL; D->n=0; D->entries_ofs=D->names_ofs=0; D->blob=NULL; D->blob_n=0;
+    free(D->render); D->render=NULL;
+    free(D->ent); D->ent=NULL; D->n=0; D->ent_size=0; D->entries_ofs=D->names_ofs=0; D->blob=NULL; D->blob_n=0; D->id=0;
 }
 
 /**
@@ -59,7 +142,7 @@ void bej_dict_free(bej_dict* D){
  * @param name_off Absolute file offset of the string.
  * @return Pointer to UTF-8 name within @ref bej_dict::blob, or NULL if invalid.
  */
-const char* bej_dict_name_at(const bej_dict* D, uint16_t name_off){
+const char* bej_dict_name_at(const bej_dict* D, uint32_t name_off){
     if(!D) return NULL;
     if(name_off==0) return NULL;
     if(name_off >= D->blob_n) return NULL;
@@ -78,13 +161,29 @@ const char* bej_dict_name_at(const bej_dict* D, uint16_t name_off){
  * @param seq Sequence number to search for.
  * @return Pointer to the matching entry within D, or NULL if not found.
  */
-const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint16_t seq){
+const bej_dict_entry* bej_cluster_lookup_seq(const bej_dict* D, bej_cluster c, uint64_t seq){
     if(!D) return NULL;
     uint32_t i = c.start_idx;
     uint32_t end = i + c.count;
     if(end > D->n) end = (uint32_t)D->n;
+    /* Clusters are normally dense and ordered by sequence number */
+    if(seq < c.count && i + seq < end && D->ent[i + seq].seq == seq) return &D->ent[i + seq];
     for(; i<end; ++i){
         if(D->ent[i].seq == seq) return &D->ent[i];
     }
     return NULL;
 }
+
+/**
+ * @brief Resolve the child cluster referenced by a dictionary entry.
+ * @param D Dictionary.
+ * @param de Entry whose children (Set members or Enum options) are wanted; may be NULL.
+ * @return Cluster of child entries, or an empty cluster if @p de has none.
+ */
+bej_cluster bej_dict_child_cluster(const bej_dict* D, const bej_dict_entry* de){
+    bej_cluster c = (bej_cluster){0,0};
+    if(!D || !de || !de->child_off || de->child_off < D->entries_ofs) return c;
+    c.start_idx = (uint32_t)(((size_t)de->child_off - D->entries_ofs)/D->ent_size);
+    c.count     = de->child_cnt;
+    return c;
+}
@@ -4,6 +4,11 @@
 /**
  * @file bej_dict.h
  * @brief Redfish schema dictionary (DSP0218 Table 31) parser.
+ *
+ * The wide-entry layout (@ref BEJ_DICT_FLAG_LOCAL_WIDE) is a local extension
+ * for dictionaries this project generates itself; it claims a header bit that
+ * DSP0218 reserves. Dictionaries from devices, files or the command line go
+ * through bej_dict_load(), which rejects that bit.
  */
 
 #include "bej.h"
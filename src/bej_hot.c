@@ -0,0 +1,255 @@
+/**
+ * @file bej_hot.c
+ * @brief Atomically swappable dictionary for long-running decoders.
+ *
+ * A slot holds the current dictionary version. Decoder threads register once
+ * and bracket each decode with bej_dict_slot_enter() / bej_dict_slot_leave():
+ * enter records the global epoch in the thread's own (cache-line sized)
+ * reader record and loads the current version, so readers take no locks and
+ * never write shared cache lines.
+ *
+ * A reloader publishes a new version with one atomic exchange, advances the
+ * epoch and retires the old version. A retired version is reclaimed once no
+ * reader is still inside a section it entered at or before the retirement
+ * epoch; if counted references (bej_dict_slot_acquire()) are still out, the
+ * last bej_dict_ref_release() frees it instead.
+ *
+ * Publish, reclaim and free are serialized among reloaders by a spin flag;
+ * readers never touch it. All atomics are sequentially consistent except
+ * the release store that closes a read section.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bej.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+struct bej_dict_ref {
+    bej_dict      D;
+    uint8_t*      blob;     /**< Owned copy of the dictionary bytes (@ref bej_dict::blob). */
+    atomic_size_t refs;     /**< Slot reference (until reclaimed) + acquired references. */
+    uint64_t      retired;  /**< Epoch at retirement: readers that entered at or below it may use this version. */
+    bej_dict_ref* next;     /**< Retired list. */
+};
+
+#define HOT_LINE 64
+
+/** Per-thread reader record, aligned to (and so padded to) a cache line. */
+typedef struct {
+    _Alignas(HOT_LINE) _Atomic uint64_t epoch; /**< Epoch seen at enter; 0 outside a read section. */
+    atomic_int       used;  /**< Claimed by bej_dict_slot_register(). */
+} hot_reader;
+_Static_assert(sizeof(hot_reader) == HOT_LINE, "one reader record per cache line");
+
+/* The records must start on a line boundary too, which plain calloc does not promise */
+#ifdef _WIN32
+static hot_reader* readers_alloc(size_t n){ return (hot_reader*)_aligned_malloc(n*sizeof(hot_reader), HOT_LINE); }
+static void readers_free(hot_reader* rd){ _aligned_free(rd); }
+#else
+static hot_reader* readers_alloc(size_t n){ return (hot_reader*)aligned_alloc(HOT_LINE, n*sizeof(hot_reader)); }
+static void readers_free(hot_reader* rd){ free(rd); }
+#endif
+
+struct bej_dict_slot {
+    _Atomic(bej_dict_ref*) cur;
+    _Atomic uint64_t       epoch;    /**< Global epoch, starts at 1 (0 means idle). */
+    atomic_flag            wlock;    /**< Serializes reloaders. */
+    bej_dict_ref*          retired;  /**< Replaced versions awaiting reclamation. */
+    hot_reader*            rd;
+    size_t                 nrd;
+    uint64_t               publishes;
+    uint64_t               freed;
+    size_t                 pending;
+};
+
+static void ref_put(bej_dict_ref* h){
+    if(atomic_fetch_sub(&h->refs, 1) != 1) return;
+    bej_dict_free(&h->D); free(h->blob); free(h);
+}
+
+static void wlock(bej_dict_slot* s){ while(atomic_flag_test_and_set_explicit(&s->wlock, memory_order_acquire)) { } }
+static void wunlock(bej_dict_slot* s){ atomic_flag_clear_explicit(&s->wlock, memory_order_release); }
+
+/* Drop the slot reference of every retired version no reader can still see */
+static void reclaim_locked(bej_dict_slot* s){
+    uint64_t min = UINT64_MAX;
+    for(size_t i=0;i<s->nrd;i++){ uint64_t e = atomic_load(&s->rd[i].epoch); if(e && e < min) min = e; }
+    bej_dict_ref** pp = &s->retired;
+    while(*pp){
+        bej_dict_ref* h = *pp;
+        if(h->retired < min){ *pp = h->next; s->pending--; s->freed++; ref_put(h); }
+        else pp = &h->next;
+    }
+}
+
+/**
+ * @brief Create an empty slot.
+ * @param max_readers Maximum number of concurrently registered reader threads.
+ * @return New slot, or NULL on allocation failure.
+ */
+bej_dict_slot* bej_dict_slot_new(size_t max_readers){
+    if(!max_readers) return NULL;
+    bej_dict_slot* s = (bej_dict_slot*)calloc(1, sizeof(*s));
+    if(!s) return NULL;
+    s->rd = max_readers <= SIZE_MAX / sizeof(hot_reader) ? readers_alloc(max_readers) : NULL;
+    if(!s->rd){ free(s); return NULL; }
+    memset(s->rd, 0, max_readers*sizeof(hot_reader));
+    s->nrd = max_readers;
+    for(size_t i=0;i<max_readers;i++){ atomic_init(&s->rd[i].epoch, 0); atomic_init(&s->rd[i].used, 0); }
+    atomic_init(&s->cur, NULL);
+    atomic_init(&s->epoch, 1);
+    atomic_flag_clear(&s->wlock);
+    return s;
+}
+
+/**
+ * @brief Free the slot, its current and all retired dictionaries.
+ *
+ * No reader may be inside a read section. References obtained with
+ * bej_dict_slot_acquire() stay valid until released.
+ */
+void bej_dict_slot_free(bej_dict_slot* s){
+    if(!s) return;
+    bej_dict_ref* h = atomic_exchange(&s->cur, NULL);
+    if(h) ref_put(h);
+    while(s->retired){ h = s->retired; s->retired = h->next; ref_put(h); }
+    readers_free(s->rd); free(s);
+}
+
+/**
+ * @brief Load a dictionary and make it the current one.
+ *
+ * The bytes are copied, so @p d may be released afterwards. The replaced
+ * dictionary is retired and reclaimed once in-flight readers are done with
+ * it (checked here and by bej_dict_slot_reclaim()). Readers are never blocked.
+ *
+ * @param s Slot.
+ * @param d Dictionary bytes.
+ * @param n Number of bytes.
+ * @return 1 on success, 0 on a malformed dictionary (current one kept) or allocation failure.
+ */
+int bej_dict_slot_publish(bej_dict_slot* s, const uint8_t* d, size_t n){
+    if(!s || !d || !n) return 0;
+    bej_dict_ref* h = (bej_dict_ref*)calloc(1, sizeof(*h));
+    uint8_t* blob = (uint8_t*)malloc(n);
+    if(!h || !blob){ free(h); free(blob); return 0; }
+    memcpy(blob, d, n);
+    if(!bej_dict_load(blob, n, &h->D)){ free(h); free(blob); return 0; }
+    h->blob = blob;
+    atomic_init(&h->refs, 1);
+
+    wlock(s);
+    bej_dict_ref* old = atomic_exchange(&s->cur, h);
+    if(old){
+        /* Readers that loaded the epoch after this increment see the new version */
+        old->retired = atomic_fetch_add(&s->epoch, 1);
+        old->next = s->retired; s->retired = old; s->pending++;
+    }
+    s->publishes++;
+    reclaim_locked(s);
+    wunlock(s);
+    return 1;
+}
+
+/**
+ * @brief Reclaim retired dictionaries whose readers have all left.
+ * @return Number of retired dictionaries still pending.
+ */
+size_t bej_dict_slot_reclaim(bej_dict_slot* s){
+    if(!s) return 0;
+    wlock(s);
+    reclaim_locked(s);
+    size_t pending = s->pending;
+    wunlock(s);
+    return pending;
+}
+
+/**
+ * @brief Claim a reader record for the calling thread.
+ * @return Reader id for enter/leave/acquire, or -1 if all records are taken.
+ */
+int bej_dict_slot_register(bej_dict_slot* s){
+    if(!s) return -1;
+    for(size_t i=0;i<s->nrd;i++){
+        int z = 0;
+        if(atomic_compare_exchange_strong(&s->rd[i].used, &z, 1)) return (int)i;
+    }
+    return -1;
+}
+
+/** @brief Release a reader record (the thread must be outside any read section). */
+void bej_dict_slot_unregister(bej_dict_slot* s, int r){
+    if(!s || r < 0 || (size_t)r >= s->nrd) return;
+    atomic_store(&s->rd[r].epoch, 0);
+    atomic_store(&s->rd[r].used, 0);
+}
+
+/**
+ * @brief Begin a read section and return the current dictionary.
+ *
+ * Lock-free: one store to the caller's own record and two loads. The
+ * dictionary stays valid until bej_dict_slot_leave(), which must be called
+ * even if NULL (nothing published yet) is returned. Sections do not nest.
+ *
+ * @param s Slot.
+ * @param r Reader id from bej_dict_slot_register().
+ */
+const bej_dict* bej_dict_slot_enter(bej_dict_slot* s, int r){
+    if(!s || r < 0 || (size_t)r >= s->nrd) return NULL;
+    atomic_store(&s->rd[r].epoch, atomic_load(&s->epoch));
+    bej_dict_ref* h = atomic_load(&s->cur);
+    return h ? &h->D : NULL;
+}
+
+/** @brief End the read section started by bej_dict_slot_enter(). */
+void bej_dict_slot_leave(bej_dict_slot* s, int r){
+    if(!s || r < 0 || (size_t)r >= s->nrd) return;
+    atomic_store_explicit(&s->rd[r].epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief Take a counted reference to the current dictionary.
+ *
+ * For holders that outlive one read section (e.g. a decode that yields).
+ * @return Reference to pass to bej_dict_ref_release(), or NULL if nothing is published.
+ */
+bej_dict_ref* bej_dict_slot_acquire(bej_dict_slot* s, int r){
+    if(!s || r < 0 || (size_t)r >= s->nrd) return NULL;
+    atomic_store(&s->rd[r].epoch, atomic_load(&s->epoch));
+    bej_dict_ref* h = atomic_load(&s->cur);
+    if(h) atomic_fetch_add(&h->refs, 1);
+    atomic_store_explicit(&s->rd[r].epoch, 0, memory_order_release);
+    return h;
+}
+
+/** @brief Dictionary behind a counted reference. */
+const bej_dict* bej_dict_ref_get(const bej_dict_ref* h){ return h ? &h->D : NULL; }
+
+/** @brief Drop a counted reference; frees a retired dictionary on the last one. */
+void bej_dict_ref_release(bej_dict_ref* h){ if(h) ref_put(h); }
+
+/**
+ * @brief Decode against the current dictionary inside one read section.
+ * @return 1 on success, 0 on malformed input or if nothing is published.
+ */
+int bej_dict_slot_decode_to_jsonw(bej_dict_slot* s, int r, bej_jsonw* jw, const uint8_t* bej, size_t bej_n){
+    const bej_dict* D = bej_dict_slot_enter(s, r);
+    int ok = D && bej_decode_to_jsonw(jw, bej, bej_n, D);
+    bej_dict_slot_leave(s, r);
+    return ok;
+}
+
+/** @brief Snapshot slot counters. */
+void bej_dict_slot_get_stats(bej_dict_slot* s, bej_dict_slot_stats* st){
+    if(!st) return;
+    memset(st, 0, sizeof(*st));
+    if(!s) return;
+    wlock(s);
+    st->publishes = s->publishes; st->freed = s->freed; st->pending = s->pending;
+    wunlock(s);
+    for(size_t i=0;i<s->nrd;i++) if(atomic_load(&s->rd[i].used)) st->readers++;
+}
@@ -0,0 +1,11 @@
+#ifndef BEJ_HOT_H_
+#define BEJ_HOT_H_
+
+/**
+ * @file bej_hot.h
+ * @brief Hot-reloadable dictionary handle (lock-free readers, epoch reclamation).
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_HOT_H_ */
@@ -3,25 +3,70 @@
  * @brief Minimal pretty JSON writer (UTF-8). Not a full JSON library.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "bej.h"
 
 /** @brief Initialize a JSON writer around a FILE*. */
-void bej_jw_init(bej_jsonw* j, FILE* f){ j->f=f; j->ind=0; j->need_comma=0; }
+void bej_jw_init(bej_jsonw* j, FILE* f){ j->f=f; j->ind=0; j->need_comma=0; j->buf=NULL; j->len=0; j->cap=0; j->oom=0; j->sink=BEJ_JW_GROW; }
+
+/**
+ * @brief Initialize a JSON writer that renders into a growable heap buffer.
+ *
+ * The result is available in @ref bej_jsonw::buf / @ref bej_jsonw::len and
+ * must be released with free(). @ref bej_jsonw::oom is set if growing failed.
+ */
+void bej_jw_init_mem(bej_jsonw* j){ bej_jw_init(j, NULL); }
+
+/**
+ * @brief Initialize a JSON writer that only measures its output.
+ *
+ * Every write advances @ref bej_jsonw::len by the number of bytes it would
+ * have produced (escapes and indentation included); nothing is stored.
+ */
+void bej_jw_init_count(bej_jsonw* j){ bej_jw_init(j, NULL); j->sink=BEJ_JW_COUNT; }
+
+/**
+ * @brief Append raw bytes to the writer's sink (no escaping).
+ * @param j JSON writer.
+ * @param s Bytes to append.
+ * @param n Number of bytes.
+ */
+void bej_jw_write(bej_jsonw* j, const char* s, size_t n){
+    if(j->f){ fwrite(s,1,n,j->f); return; }
+    if(j->sink==BEJ_JW_COUNT){ j->len+=n; return; }
+    if(j->sink==BEJ_JW_FIXED){ memcpy(j->buf+j->len, s, n); j->len+=n; return; }
+    if(j->oom) return;
+    if(j->len+n > j->cap){
+        size_t cap = j->cap ? j->cap : 256;
+        while(cap < j->len+n) cap *= 2;
+        char* b = (char*)realloc(j->buf, cap);
+        if(!b){ j->oom=1; return; }
+        j->buf=b; j->cap=cap;
+    }
+    memcpy(j->buf+j->len, s, n); j->len+=n;
+}
+
+static void jw_putc(bej_jsonw* j, char c){ if(j->f) fputc(c,j->f); else bej_jw_write(j,&c,1); }
+static void jw_puts(bej_jsonw* j, const char* s){ if(j->f) fputs(s,j->f); else bej_jw_write(j,s,strlen(s)); }
+
+/** @brief Append a raw NUL-terminated string (separators, literals such as null). */
+void bej_jw_raw(bej_jsonw* j, const char* s){ jw_puts(j,s); }
 
 /** @brief Emit a newline and indentation spaces. */
-void bej_jw_nl(bej_jsonw* j){ fputc('\n',j->f); for(int i=0;i<j->ind;i++) fputs("   ", j->f); }
+void bej_jw_nl(bej_jsonw* j){ jw_putc(j,'\n'); for(int i=0;i<j->ind;i++) jw_puts(j,"   "); }
 
 /** @brief Begin a JSON object. */
-void bej_jw_begin_obj(bej_jsonw* j){ fputs("{",j->f); j->ind++; j->need_comma=0; bej_jw_nl(j); }
+void bej_jw_begin_obj(bej_jsonw* j){ jw_puts(j,"{"); j->ind++; j->need_comma=0; bej_jw_nl(j); }
 
 /** @brief End a JSON object. */
-void bej_jw_end_obj(bej_jsonw* j){ bej_jw_nl(j); j->ind--; fputs("}", j->f); j->need_comma=1; }
+void bej_jw_end_obj(bej_jsonw* j){ bej_jw_nl(j); j->ind--; jw_puts(j,"}"); j->need_comma=1; }
 
 /** @brief Begin a JSON array. */
-void bej_jw_begin_arr(bej_jsonw* j){ fputs("[",j->f); j->ind++; j->need_comma=0; }
+void bej_jw_begin_arr(bej_jsonw* j){ jw_puts(j,"["); j->ind++; j->need_comma=0; }
 
 /** @brief End a JSON array. */
-void bej_jw_end_arr(bej_jsonw* j){ j->ind--; fputs("]", j->f); j->need_comma=1; }
+void bej_jw_end_arr(bej_jsonw* j){ j->ind--; jw_puts(j,"]"); j->need_comma=1; }
 
 /**
  * @brief Emit a JSON object key (with quoting/escaping) and prepare for a value.
@@ -29,14 +74,34 @@ void bej_jw_end_arr(bej_jsonw* j){ j->ind--; fputs("]", j->f); j->need_comma=1;
  * @param k Null-terminated UTF-8 key.
  */
 void bej_jw_key(bej_jsonw* j, const char* k){
-    if(j->need_comma) fputs(",\n", j->f); else j->need_comma=1;
-    for(int i=0;i<j->ind;i++) fputs("   ", j->f);
-    fputc('"',j->f);
+    if(j->need_comma) jw_puts(j,",\n"); else j->need_comma=1;
+    for(int i=0;i<j->ind;i++) jw_puts(j,"   ");
+    jw_putc(j,'"');
     for(const char* p=k;*p;p++){
-        if(*p=='"'||*p=='\\'){ fputc('\\',j->f); fputc(*p,j->f); }
-        else fputc(*p,j->f);
+        if(*p=='"'||*p=='\\'){ jw_putc(j,'\\'); jw_putc(j,*p); }
+        else jw_putc(j,*p);
     }
-    fputs("\": ", j->f);
+    jw_puts(j,"\": ");
+}
+
+/**
+ * @brief Emit a pre-rendered object key and prepare for a value.
+ *
+ * Same output as bej_jw_key(), but @p qk already holds the quoted, escaped
+ * key followed by `": ` (e.g. `"Slot": `), so it is written in one copy.
+ * @param j JSON writer.
+ * @param qk Pre-rendered key bytes.
+ * @param n Length of @p qk.
+ */
+void bej_jw_key_lit(bej_jsonw* j, const char* qk, size_t n){
+    /* Separator and indentation in one copy for the usual nesting depths */
+    static const char pad[] = ",\n" "                                                "
+                              "                                                ";
+    size_t sep = j->need_comma ? 2 : 0, w = 3*(size_t)(j->ind > 0 ? j->ind : 0);
+    j->need_comma = 1;
+    if(sep + w < sizeof(pad)) bej_jw_write(j, pad + 2 - sep, sep + w);
+    else { if(sep) bej_jw_write(j, ",\n", 2); for(int i=0;i<j->ind;i++) bej_jw_write(j, "   ", 3); }
+    bej_jw_write(j, qk, n);
 }
 
 /**
@@ -45,13 +110,58 @@ void bej_jw_key(bej_jsonw* j, const char* k){
  * @param s Null-terminated UTF-8 string.
  */
 void bej_jw_str(bej_jsonw* j, const char* s){
-    fputc('"',j->f);
+    jw_putc(j,'"');
     for(const char* p=s;*p;p++){
-        if(*p=='"'||*p=='\\'){ fputc('\\',j->f); fputc(*p,j->f); }
-        else if(*p=='\n') fputs("\\n",j->f);
-        else fputc(*p,j->f);
+        if(*p=='"'||*p=='\\'){ jw_putc(j,'\\'); jw_putc(j,*p); }
+        else if(*p=='\n') jw_puts(j,"\\n");
+        else jw_putc(j,*p);
+    }
+    jw_putc(j,'"');
+}
+
+/**
+ * @brief Emit a JSON string value from a length-delimited buffer.
+ *
+ * Stops at @p n bytes or at the first NUL, whichever comes first; unescaped
+ * runs are written in bulk.
+ * @param j JSON writer.
+ * @param s UTF-8 bytes (need not be NUL-terminated).
+ * @param n Maximum number of bytes.
+ */
+void bej_jw_strn(bej_jsonw* j, const char* s, size_t n){
+    jw_putc(j,'"');
+    bej_jw_esc(j, s, n);
+    jw_putc(j,'"');
+}
+
+/**
+ * @brief Emit the escaped body of a string value, without quotes.
+ *
+ * Lets a value that arrives in pieces be written as one JSON string.
+ * @param j JSON writer.
+ * @param s UTF-8 bytes (need not be NUL-terminated).
+ * @param n Maximum number of bytes.
+ * @return Number of bytes consumed: @p n, or the offset of the first NUL.
+ */
+size_t bej_jw_esc(bej_jsonw* j, const char* s, size_t n){
+    if(!j->f && j->sink==BEJ_JW_COUNT){
+        /* Sizing: length up to the NUL plus one byte per escaped character */
+        const char* z = (const char*)memchr(s, 0, n);
+        size_t m = z ? (size_t)(z-s) : n, e = 0;
+        for(size_t i=0;i<m;i++){ char c=s[i]; e += (size_t)((c=='"') | (c=='\\') | (c=='\n')); }
+        j->len += m + e;
+        return m;
+    }
+    size_t run=0, i=0;
+    for(; i<n && s[i]; i++){
+        char c=s[i];
+        if(c!='"' && c!='\\' && c!='\n') continue;
+        bej_jw_write(j, s+run, i-run);
+        if(c=='\n') jw_puts(j,"\\n"); else { jw_putc(j,'\\'); jw_putc(j,c); }
+        run=i+1;
     }
-    fputc('"',j->f);
+    bej_jw_write(j, s+run, i-run);
+    return i;
 }
 
 /**
@@ -59,4 +169,13 @@ void bej_jw_str(bej_jsonw* j, const char* s){
  * @param j JSON writer.
  * @param v Signed integer.
  */
-void bej_jw_int(bej_jsonw* j, long long v){ char buf[64]; snprintf(buf,sizeof(buf),"%lld",v); fputs(buf,j->f); }
+void bej_jw_int(bej_jsonw* j, long long v){
+    if(!j->f && j->sink==BEJ_JW_COUNT){
+        /* Width of %lld without formatting */
+        unsigned long long u = v<0 ? 0ull-(unsigned long long)v : (unsigned long long)v;
+        size_t w = v<0 ? 2 : 1;
+        while(u >= 10){ u /= 10; w++; }
+        j->len += w; return;
+    }
+    char buf[64]; snprintf(buf,sizeof(buf),"%lld",v); jw_puts(j,buf);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file bej_pred.c
+ * @brief Property predicates evaluated directly on BEJ payloads.
+ *
+ * A predicate such as `MemoryLocation/Slot>=2` is resolved against the
+ * dictionary once (names -> sequence numbers, enum option name -> ordinal).
+ * Evaluation walks only the tuples on the property path: every other member
+ * is skipped by its length field without being decoded.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "bej.h"
+
+/**
+ * @brief Lookup an entry within a cluster by property name.
+ * @param D Dictionary.
+ * @param c Cluster to search.
+ * @param name NUL-terminated name.
+ * @param name_n Number of bytes of @p name to compare (name need not be terminated there).
+ * @return Pointer to the matching entry within D, or NULL if not found.
+ */
+const bej_dict_entry* bej_cluster_lookup_name(const bej_dict* D, bej_cluster c, const char* name, size_t name_n){
+    if(!D || !name) return NULL;
+    uint32_t end = c.start_idx + c.count;
+    if(end > D->n) end = (uint32_t)D->n;
+    for(uint32_t i=c.start_idx; i<end; ++i){
+        const char* s = D->ent[i].name_off ? bej_dict_name_at(D, D->ent[i].name_off) : NULL;
+        if(s && strncmp(s, name, name_n)==0 && s[name_n]==0) return &D->ent[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compile `path<op>value` against a dictionary.
+ *
+ * Path components are separated by '/'; operators are `=`, `!=`, `<`, `<=`,
+ * `>`, `>=`. Integer properties compare numerically; String and Enum
+ * properties support `=` and `!=` only.
+ *
+ * @param P Output compiled predicate.
+ * @param D Dictionary the payloads are encoded with.
+ * @param expr Predicate text.
+ * @return 1 on success, 0 if the expression or property path is invalid.
+ */
+int bej_pred_compile(bej_pred* P, const bej_dict* D, const char* expr){
+    if(!P || !D || !expr) return 0;
+    memset(P, 0, sizeof(*P));
+
+    const char* op = strpbrk(expr, "=!<>");
+    if(!op || op==expr) return 0;
+    const char* val;
+    if(op[0]=='!' && op[1]=='='){ P->op=BEJ_PRED_NE; val=op+2; }
+    else if(op[0]=='<' && op[1]=='='){ P->op=BEJ_PRED_LE; val=op+2; }
+    else if(op[0]=='>' && op[1]=='='){ P->op=BEJ_PRED_GE; val=op+2; }
+    else if(op[0]=='<'){ P->op=BEJ_PRED_LT; val=op+1; }
+    else if(op[0]=='>'){ P->op=BEJ_PRED_GT; val=op+1; }
+    else if(op[0]=='='){ P->op=BEJ_PRED_EQ; val=op+1; }
+    else return 0;
+
+    /* Resolve the path one Set level at a time */
+    bej_cluster cl = bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL);
+    const bej_dict_entry* de = NULL;
+    const char* p = expr;
+    while(p < op){
+        const char* e = p;
+        while(e < op && *e!='/') e++;
+        if(e==p || P->depth >= BEJ_PRED_MAX_DEPTH) return 0;
+        if(de) cl = bej_dict_child_cluster(D, de);
+        de = bej_cluster_lookup_name(D, cl, p, (size_t)(e-p));
+        if(!de) return 0;
+        P->seq[P->depth++] = de->seq;
+        p = (e<op) ? e+1 : e;
+    }
+    if(!de) return 0;
+
+    P->fmt = (uint8_t)(de->fmt >> 4);
+    if(P->fmt==BEJ_FMT_INT){
+        char* end; P->ival = strtoll(val, &end, 10);
+        if(end==val || *end) return 0;
+    }else if(P->fmt==BEJ_FMT_STRING){
+        if(P->op!=BEJ_PRED_EQ && P->op!=BEJ_PRED_NE) return 0;
+        P->sval = val; P->sval_n = strlen(val);
+    }else if(P->fmt==BEJ_FMT_ENUM){
+        if(P->op!=BEJ_PRED_EQ && P->op!=BEJ_PRED_NE) return 0;
+        const bej_dict_entry* opt = bej_cluster_lookup_name(D, bej_dict_child_cluster(D, de), val, strlen(val));
+        if(!opt) return 0;
+        P->ival = opt->seq;
+    }else{
+        return 0;
+    }
+    return 1;
+}
+
+static int cmp_int(int op, long long a, long long b){
+    switch(op){
+    case BEJ_PRED_EQ: return a==b;
+    case BEJ_PRED_NE: return a!=b;
+    case BEJ_PRED_LT: return a<b;
+    case BEJ_PRED_LE: return a<=b;
+    case BEJ_PRED_GT: return a>b;
+    default:          return a>=b;
+    }
+}
+
+/**
+ * @brief Evaluate a compiled predicate on one payload without decoding it.
+ *
+ * @param P Compiled predicate.
+ * @param bej BEJ payload (bejEncoding header + root Set).
+ * @param bej_n Length of @p bej.
+ * @return 1 if the property exists and satisfies the predicate, 0 if not
+ *         (including absent properties), -1 on malformed input.
+ */
+int bej_pred_eval(const bej_pred* P, const uint8_t* bej, size_t bej_n){
+    if(!P || !bej) return -1;
+    bej_br br; bej_br_init(&br, bej, bej_n);
+    if(!bej_br_seek(&br, 7)) return -1;
+    uint64_t S; if(!bej_read_nnint(&br,&S)) return -1;
+    uint8_t F;  if(!bej_br_u8(&br,&F)) return -1;
+    uint64_t L; if(!bej_read_nnint(&br,&L)) return -1;
+    if((F>>4) != BEJ_FMT_SET) return -1;
+
+    for(unsigned d=0; d<P->depth; d++){
+        /* br is at a Set value: find member seq[d], skipping the others by length */
+        uint64_t count; if(!bej_read_nnint(&br,&count)) return -1;
+        int found = 0;
+        for(uint64_t i=0;i<count;i++){
+            if(!bej_read_nnint(&br,&S)) return -1;
+            if(!bej_br_u8(&br,&F)) return -1;
+            if(!bej_read_nnint(&br,&L)) return -1;
+            if(L > bej_br_left(&br)) return -1;
+            if(!(S & 1u) && (S>>1)==P->seq[d]){ found = 1; break; }
+            br.p += (size_t)L;
+        }
+        if(!found) return 0;
+        if(d+1 < P->depth && (F>>4) != BEJ_FMT_SET) return 0;
+    }
+
+    uint8_t fmt = (uint8_t)(F>>4);
+    if(fmt != P->fmt) return 0;
+    const uint8_t* v = br.d + br.p;
+    if(fmt==BEJ_FMT_INT){
+        /* Same (unsigned, little-endian) interpretation as the JSON decoder */
+        if(L > 8) return -1;
+        uint64_t x = 0;
+        for(size_t i=0;i<(size_t)L;i++) x |= (uint64_t)v[i] << (8*i);
+        return cmp_int(P->op, (long long)x, P->ival);
+    }
+    if(fmt==BEJ_FMT_ENUM){
+        bej_br ev; bej_br_init(&ev, v, (size_t)L);
+        uint64_t ord; if(!bej_read_nnint(&ev,&ord)) return -1;
+        return cmp_int(P->op, (long long)ord, P->ival);
+    }
+    /* String: ends at the first NUL, like the decoder renders it */
+    size_t n = 0;
+    while(n < (size_t)L && v[n]) n++;
+    int eq = (n==P->sval_n && memcmp(v, P->sval, n)==0);
+    return P->op==BEJ_PRED_EQ ? eq : !eq;
+}
@@ -0,0 +1,11 @@
+#ifndef BEJ_PRED_H_
+#define BEJ_PRED_H_
+
+/**
+ * @file bej_pred.h
+ * @brief Property predicates evaluated on raw BEJ payloads.
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_PRED_H_ */
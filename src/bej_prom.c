@@ -0,0 +1,398 @@
+/**
+ * @file bej_prom.c
+ * @brief OpenMetrics exporter: mapped properties rendered as samples while decoding.
+ *
+ * A mapping file names the properties to export, one per line:
+ *
+ *     # path                 metric[{labels}]                 [gauge|counter] [Option=value ...]
+ *     CapacityMiB            redfish_memory_capacity_mib
+ *     Status/Health          redfish_memory_health{kind="dimm"}  OK=0 Warning=1 Critical=2
+ *
+ * It is resolved against the dictionary once: path components become
+ * per-Set routing tables (member seq -> sample or nested Set), enum option
+ * names become ordinals. Integer properties export their value; Enum
+ * properties export the mapped number (options without one produce no
+ * sample) or, when no options are listed, the ordinal. Decoding follows only
+ * the mapped Sets; every other member is skipped by its length field.
+ *
+ * Samples are rendered as text straight into per-family buffers, so payloads
+ * of several resources can be added before bej_prom_write() emits each
+ * family once (`# TYPE` line, then its samples) and the closing `# EOF`.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "bej.h"
+
+/* Per-Set routing table: member seq -> mapping or nested Set node (-1: skip) */
+typedef struct { int32_t map; int32_t node; } prom_slot;
+typedef struct {
+    prom_slot*  slot;
+    size_t      nslot;
+    bej_cluster cl;
+} prom_node;
+
+typedef struct {
+    char*  name;      /**< Family name (`_total` stripped for counters). */
+    int    counter;
+    char*  buf;       /**< Rendered samples. */
+    size_t n, cap;
+} prom_fam;
+
+typedef struct {
+    uint32_t fam;
+    uint8_t  fmt;        /**< BEJ_FMT_INT or BEJ_FMT_ENUM. */
+    char*    head;       /**< Sample name, plus `{` and the static labels if any. */
+    size_t   head_n;
+    int      labels;     /**< Static labels present. */
+    char**   opt;        /**< Enum ordinal -> value text (NULL: no sample). */
+    size_t   nopt;       /**< 0: the ordinal is the value. */
+} prom_map;
+
+struct bej_prom {
+    const bej_dict* D;
+    prom_node* node;  size_t nnode;
+    prom_map*  map;   size_t nmap;
+    prom_fam*  fam;   size_t nfam;
+    size_t*    mark;     /**< Family lengths when bej_prom_add() started (rollback). */
+    size_t     pending;  /**< Samples buffered since the last write. */
+};
+
+/* ---- mapping ---- */
+
+static int is_name0(char c){ return (c>='a'&&c<='z') || (c>='A'&&c<='Z') || c=='_'; }
+static int is_name(char c){ return is_name0(c) || (c>='0'&&c<='9'); }
+static const char* skip_ws(const char* p, const char* e){ while(p<e && (*p==' '||*p=='\t'||*p=='\r')) p++; return p; }
+static const char* tok_end(const char* p, const char* e){ while(p<e && *p!=' ' && *p!='\t' && *p!='\r') p++; return p; }
+
+static char* dup_n(const char* s, size_t n){
+    char* d = (char*)malloc(n+1);
+    if(d){ memcpy(d, s, n); d[n] = 0; }
+    return d;
+}
+
+/* `name="value"{,name="value"}` up to the closing brace; returns its position or NULL */
+static const char* scan_labels(const char* p, const char* e){
+    for(;;){
+        if(p>=e || !is_name0(*p)) return NULL;
+        while(p<e && is_name(*p)) p++;
+        if(e-p < 2 || p[0]!='=' || p[1]!='"') return NULL;
+        for(p+=2; p<e && *p!='"'; p++){
+            if(*p=='\n') return NULL;
+            if(*p=='\\'){ if(p+1>=e || (p[1]!='\\' && p[1]!='"' && p[1]!='n')) return NULL; p++; }
+        }
+        if(p>=e) return NULL;
+        p++;
+        if(p<e && *p=='}') return p;
+        if(p>=e || *p!=',') return NULL;
+        p++;
+    }
+}
+
+static int is_number(const char* s, size_t n){
+    char t[64];
+    if(n==0 || n>=sizeof(t)) return 0;
+    memcpy(t, s, n); t[n] = 0;
+    char* end; (void)strtod(t, &end);
+    return *end==0;
+}
+
+/* Routing node for cluster cl; slots sized by the largest seq in it */
+static int32_t add_node(bej_prom* P, bej_cluster cl){
+    prom_node* nd = (prom_node*)realloc(P->node, (P->nnode+1)*sizeof(*nd));
+    if(!nd) return -1;
+    P->node = nd;
+    const bej_dict* D = P->D;
+    uint32_t end = cl.start_idx + cl.count;
+    if(end > D->n) end = (uint32_t)D->n;
+    size_t nslot = 0;
+    for(uint32_t i=cl.start_idx;i<end;i++) if((size_t)D->ent[i].seq+1 > nslot) nslot = (size_t)D->ent[i].seq+1;
+    prom_slot* s = nslot ? (prom_slot*)malloc(nslot*sizeof(*s)) : NULL;
+    if(nslot && !s) return -1;
+    for(size_t k=0;k<nslot;k++){ s[k].map = -1; s[k].node = -1; }
+    nd = &P->node[P->nnode];
+    nd->slot = s; nd->nslot = nslot; nd->cl = cl;
+    return (int32_t)P->nnode++;
+}
+
+static int32_t find_fam(bej_prom* P, const char* name, size_t n, int counter){
+    for(size_t i=0;i<P->nfam;i++)
+        if(strlen(P->fam[i].name)==n && memcmp(P->fam[i].name, name, n)==0) return P->fam[i].counter==counter ? (int32_t)i : -1;
+    prom_fam* f = (prom_fam*)realloc(P->fam, (P->nfam+1)*sizeof(*f));
+    if(!f) return -1;
+    P->fam = f;
+    f = &P->fam[P->nfam];
+    memset(f, 0, sizeof(*f));
+    f->counter = counter;
+    if(!(f->name = dup_n(name, n))) return -1;
+    return (int32_t)P->nfam++;
+}
+
+/* One mapping line; 0 if it is invalid (or allocation failed) */
+static int parse_line(bej_prom* P, const char* p, const char* e){
+    const bej_dict* D = P->D;
+
+    /* Property path -> leaf entry, creating routing nodes on the way */
+    const char* pe = tok_end(p, e);
+    int32_t node = 0;
+    const bej_dict_entry* de = NULL;
+    int depth = 0;
+    while(p < pe){
+        const char* c = p;
+        while(c < pe && *c!='/') c++;
+        if(c==p || ++depth > BEJ_PROM_MAX_DEPTH) return 0;
+        if(de){
+            if((de->fmt>>4)!=BEJ_FMT_SET) return 0;
+            prom_slot* s = &P->node[node].slot[de->seq];
+            if(s->node < 0){
+                int32_t child = add_node(P, bej_dict_child_cluster(D, de));
+                if(child < 0) return 0;
+                P->node[node].slot[de->seq].node = child;
+                s = &P->node[node].slot[de->seq];
+            }
+            node = s->node;
+        }
+        de = bej_cluster_lookup_name(D, P->node[node].cl, p, (size_t)(c-p));
+        if(!de || de->seq >= P->node[node].nslot) return 0;
+        p = (c<pe) ? c+1 : c;
+    }
+    uint8_t fmt = de ? (uint8_t)(de->fmt>>4) : 0xFF;
+    if(fmt!=BEJ_FMT_INT && fmt!=BEJ_FMT_ENUM) return 0;
+    if(P->node[node].slot[de->seq].map >= 0) return 0;   /* path mapped twice */
+
+    /* metric[{labels}] */
+    p = skip_ws(pe, e);
+    const char* mn = p;
+    if(p>=e || !(is_name0(*p) || *p==':')) return 0;
+    while(p<e && (is_name(*p) || *p==':')) p++;
+    size_t mn_n = (size_t)(p-mn);
+    const char* lb = NULL; size_t lb_n = 0;
+    if(p<e && *p=='{'){
+        const char* rb = scan_labels(p+1, e);
+        if(!rb) return 0;
+        lb = p+1; lb_n = (size_t)(rb-lb);
+        p = rb+1;
+    }
+    if(p<e && *p!=' ' && *p!='\t' && *p!='\r') return 0;
+
+    /* [gauge|counter] [Option=value ...] */
+    int counter = 0, nvals = 0;
+    for(const char* q = skip_ws(p, e); q<e; q = skip_ws(tok_end(q, e), e)){
+        size_t n = (size_t)(tok_end(q, e)-q);
+        if(n==7 && memcmp(q, "counter", 7)==0) counter = 1;
+        else if(n==5 && memcmp(q, "gauge", 5)==0) counter = 0;
+        else if(fmt==BEJ_FMT_ENUM && memchr(q, '=', n)) nvals++;
+        else return 0;
+    }
+
+    size_t fam_n = mn_n;
+    if(counter && fam_n > 6 && memcmp(mn+fam_n-6, "_total", 6)==0) fam_n -= 6;
+    int32_t fam = find_fam(P, mn, fam_n, counter);
+    if(fam < 0) return 0;
+
+    prom_map* mp = (prom_map*)realloc(P->map, (P->nmap+1)*sizeof(*mp));
+    if(!mp) return 0;
+    P->map = mp;
+    prom_map* m = &P->map[P->nmap];
+    memset(m, 0, sizeof(*m));
+    m->fam = (uint32_t)fam; m->fmt = fmt; m->labels = lb != NULL;
+    m->head_n = fam_n + (counter ? 6 : 0) + (lb ? 1 + lb_n : 0);
+    if(!(m->head = (char*)malloc(m->head_n + 1))) return 0;
+    memcpy(m->head, mn, fam_n);
+    size_t h = fam_n;
+    if(counter){ memcpy(m->head+h, "_total", 6); h += 6; }
+    if(lb){ m->head[h++] = '{'; memcpy(m->head+h, lb, lb_n); h += lb_n; }
+    m->head[h] = 0;
+    P->nmap++;   /* owned from here on, even if the options fail below */
+
+    if(nvals){
+        bej_cluster oc = bej_dict_child_cluster(D, de);
+        uint32_t end = oc.start_idx + oc.count;
+        if(end > D->n) end = (uint32_t)D->n;
+        for(uint32_t i=oc.start_idx;i<end;i++) if((size_t)D->ent[i].seq+1 > m->nopt) m->nopt = (size_t)D->ent[i].seq+1;
+        if(!m->nopt || !(m->opt = (char**)calloc(m->nopt, sizeof(char*)))){ m->nopt = 0; return 0; }
+        for(const char* q = skip_ws(p, e); q<e; q = skip_ws(tok_end(q, e), e)){
+            const char* qe = tok_end(q, e);
+            const char* eq = (const char*)memchr(q, '=', (size_t)(qe-q));
+            if(!eq) continue;   /* type keyword */
+            const bej_dict_entry* o = bej_cluster_lookup_name(D, oc, q, (size_t)(eq-q));
+            if(!o || o->seq >= m->nopt || m->opt[o->seq] || !is_number(eq+1, (size_t)(qe-eq-1))) return 0;
+            if(!(m->opt[o->seq] = dup_n(eq+1, (size_t)(qe-eq-1)))) return 0;
+        }
+    }
+    P->node[node].slot[de->seq].map = (int32_t)(P->nmap-1);
+    return 1;
+}
+
+/**
+ * @brief Compile a mapping file against a dictionary.
+ *
+ * @param D Dictionary the payloads are encoded with; must outlive the exporter.
+ * @param map Mapping text (see the file comment); need not be NUL-terminated.
+ * @param map_n Length of @p map.
+ * @param err_line Optional output: 1-based line of the first invalid mapping;
+ *        0 on success or allocation failure.
+ * @return New exporter (release with bej_prom_free()), or NULL.
+ */
+bej_prom* bej_prom_new(const bej_dict* D, const char* map, size_t map_n, size_t* err_line){
+    if(err_line) *err_line = 0;
+    if(!D || (!map && map_n)) return NULL;
+    bej_prom* P = (bej_prom*)calloc(1, sizeof(*P));
+    if(!P) return NULL;
+    P->D = D;
+    if(add_node(P, bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL)) < 0){ bej_prom_free(P); return NULL; }
+    size_t line = 0;
+    for(const char* p = map, *end = map + map_n; p < end; ){
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end-p));
+        const char* e = nl ? nl : end;
+        line++;
+        const char* q = skip_ws(p, e);
+        while(e > q && (e[-1]==' ' || e[-1]=='\t' || e[-1]=='\r')) e--;
+        if(q < e && *q!='#' && !parse_line(P, q, e)){
+            if(err_line) *err_line = line;
+            bej_prom_free(P);
+            return NULL;
+        }
+        p = nl ? nl+1 : end;
+    }
+    if(P->nfam && !(P->mark = (size_t*)calloc(P->nfam, sizeof(size_t)))){ bej_prom_free(P); return NULL; }
+    return P;
+}
+
+/** @brief Release the exporter and any samples not yet written. */
+void bej_prom_free(bej_prom* P){
+    if(!P) return;
+    for(size_t i=0;i<P->nnode;i++) free(P->node[i].slot);
+    for(size_t i=0;i<P->nmap;i++){
+        for(size_t o=0;o<P->map[i].nopt;o++) free(P->map[i].opt[o]);
+        free(P->map[i].opt); free(P->map[i].head);
+    }
+    for(size_t i=0;i<P->nfam;i++){ free(P->fam[i].name); free(P->fam[i].buf); }
+    free(P->node); free(P->map); free(P->fam); free(P->mark);
+    free(P);
+}
+
+/* ---- samples ---- */
+
+static int put(prom_fam* f, const char* s, size_t n){
+    if(f->n + n > f->cap){
+        size_t cap = f->cap ? f->cap : 256;
+        while(cap < f->n + n) cap *= 2;
+        char* b = (char*)realloc(f->buf, cap);
+        if(!b) return 0;
+        f->buf = b; f->cap = cap;
+    }
+    memcpy(f->buf + f->n, s, n); f->n += n;
+    return 1;
+}
+
+/* `head{static,labels} value\n` */
+static int emit(bej_prom* P, const prom_map* m, const char* lab, size_t lab_n, const char* v, size_t vn){
+    prom_fam* f = &P->fam[m->fam];
+    int ok = put(f, m->head, m->head_n);
+    if(m->labels){
+        if(lab_n) ok = ok && put(f, ",", 1) && put(f, lab, lab_n);
+        ok = ok && put(f, "} ", 2);
+    }else if(lab_n){
+        ok = ok && put(f, "{", 1) && put(f, lab, lab_n) && put(f, "} ", 2);
+    }else ok = ok && put(f, " ", 1);
+    ok = ok && put(f, v, vn) && put(f, "\n", 1);
+    P->pending += (size_t)ok;
+    return ok;
+}
+
+static int prom_value(bej_prom* P, const prom_map* m, uint8_t fmt, const uint8_t* v, uint64_t L,
+                      const char* lab, size_t lab_n){
+    if(fmt != m->fmt) return 1;   /* format differs from the dictionary: no sample */
+    char t[24];
+    if(fmt==BEJ_FMT_INT){
+        /* Same (unsigned, little-endian) interpretation as the JSON decoder */
+        if(L > 8) return 0;
+        uint64_t x = 0;
+        for(size_t i=0;i<(size_t)L;i++) x |= (uint64_t)v[i] << (8*i);
+        return emit(P, m, lab, lab_n, t, (size_t)snprintf(t, sizeof(t), "%lld", (long long)x));
+    }
+    bej_br ev; bej_br_init(&ev, v, (size_t)L);
+    uint64_t o; if(!bej_read_nnint(&ev, &o)) return 0;
+    if(!m->nopt) return emit(P, m, lab, lab_n, t, (size_t)snprintf(t, sizeof(t), "%llu", (unsigned long long)o));
+    if(o >= m->nopt || !m->opt[o]) return 1;   /* option without a value */
+    return emit(P, m, lab, lab_n, m->opt[o], strlen(m->opt[o]));
+}
+
+static int prom_set(bej_prom* P, bej_br* br, int32_t node, const char* lab, size_t lab_n, int depth){
+    if(depth > BEJ_PROM_MAX_DEPTH) return 0;
+    const prom_node* nd = &P->node[node];
+    uint64_t count; if(!bej_read_nnint(br,&count)) return 0;
+    for(uint64_t i=0;i<count;i++){
+        uint64_t S; if(!bej_read_nnint(br,&S)) return 0;
+        uint8_t  F; if(!bej_br_u8(br,&F)) return 0;
+        uint64_t L; if(!bej_read_nnint(br,&L)) return 0;
+        if(L > bej_br_left(br)) return 0;
+        size_t end = br->p + (size_t)L;
+        uint64_t seq = S >> 1;
+        if(!(S & 1u) && seq < nd->nslot){
+            const prom_slot* s = &nd->slot[seq];
+            uint8_t fmt = (uint8_t)(F >> 4);
+            if(s->map >= 0){
+                if(!prom_value(P, &P->map[s->map], fmt, br->d + br->p, L, lab, lab_n)) return 0;
+            }else if(s->node >= 0 && fmt==BEJ_FMT_SET){
+                bej_br sub; bej_br_init(&sub, br->d + br->p, (size_t)L);
+                if(!prom_set(P, &sub, s->node, lab, lab_n, depth+1)) return 0;
+            }
+        }
+        br->p = end;   /* unmapped members and subtrees are skipped by length */
+    }
+    return 1;
+}
+
+/**
+ * @brief Render the mapped properties of one payload as samples.
+ *
+ * @param P Exporter.
+ * @param bej BEJ payload (bejEncoding header + root Set) encoded with the exporter's dictionary.
+ * @param bej_n Length of @p bej.
+ * @param labels Optional labels added to every sample of this payload, already
+ *        in exposition form (e.g. `resource="/redfish/v1/.../DIMM0"`); NULL or "" for none.
+ * @return 1 on success; 0 on malformed input or allocation failure (no samples are kept).
+ */
+int bej_prom_add(bej_prom* P, const uint8_t* bej, size_t bej_n, const char* labels){
+    if(!P || !bej) return 0;
+    for(size_t i=0;i<P->nfam;i++) P->mark[i] = P->fam[i].n;
+    size_t pending = P->pending;
+    size_t lab_n = labels ? strlen(labels) : 0;
+
+    bej_br br; bej_br_init(&br, bej, bej_n);
+    uint64_t S, L; uint8_t F;
+    int ok = bej_br_seek(&br, 7) && bej_read_nnint(&br,&S) && bej_br_u8(&br,&F) && bej_read_nnint(&br,&L)
+          && (F>>4)==BEJ_FMT_SET && prom_set(P, &br, 0, labels, lab_n, 0);
+    if(!ok){
+        for(size_t i=0;i<P->nfam;i++) P->fam[i].n = P->mark[i];
+        P->pending = pending;
+    }
+    return ok;
+}
+
+/** @brief Number of samples buffered since the last bej_prom_write(). */
+size_t bej_prom_pending(const bej_prom* P){ return P ? P->pending : 0; }
+
+/**
+ * @brief Write the buffered samples as one OpenMetrics exposition and clear them.
+ *
+ * Families appear in mapping-file order, each with its `# TYPE` line; families
+ * without samples are left out. The exposition ends with `# EOF`.
+ * @return 1 on success, 0 on I/O error.
+ */
+int bej_prom_write(bej_prom* P, FILE* out){
+    if(!P || !out) return 0;
+    int ok = 1;
+    for(size_t i=0;i<P->nfam && ok;i++){
+        prom_fam* f = &P->fam[i];
+        if(!f->n) continue;
+        ok = fprintf(out, "# TYPE %s %s\n", f->name, f->counter ? "counter" : "gauge") > 0
+          && fwrite(f->buf, 1, f->n, out)==f->n;
+    }
+    ok = ok && fputs("# EOF\n", out) >= 0;
+    for(size_t i=0;i<P->nfam;i++) P->fam[i].n = 0;
+    P->pending = 0;
+    return ok;
+}
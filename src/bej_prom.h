@@ -0,0 +1,11 @@
+#ifndef BEJ_PROM_H_
+#define BEJ_PROM_H_
+
+/**
+ * @file bej_prom.h
+ * @brief OpenMetrics exporter: mapped BEJ properties rendered as metric samples.
+ */
+
+#include "bej.h"
+
+#endif /* BEJ_PROM_H_ */
@@ -1,6 +1,11 @@
 /**
  * @file bej_reader.c
  * @brief Byte reader and nnint utilities.
+ *
+ * A reader covers either one contiguous buffer or a scatter-gather list of
+ * segments (bej_br_init_iov()). Every accessor has a fast path for reads
+ * that stay inside the current segment; only reads that reach its end take
+ * the slow path, which walks to the following segments. Nothing is coalesced.
  */
 
 #include <string.h>
@@ -12,7 +17,46 @@
  * @param d Pointer to the buffer data.
  * @param n Size of the buffer in bytes.
  */
-void bej_br_init(bej_br* b, const uint8_t* d, size_t n){ b->d=d; b->n=n; b->p=0; }
+void bej_br_init(bej_br* b, const uint8_t* d, size_t n){
+    b->d=d; b->n=n; b->p=0; b->seg=NULL; b->nseg=0; b->si=0; b->base=0; b->total=n;
+}
+
+/**
+ * @brief Initialize a reader over a list of segments (read as one stream).
+ * @param b Reader instance to initialize.
+ * @param seg Segments; the array and the data must outlive the reader.
+ * @param nseg Number of segments (empty segments are allowed).
+ */
+void bej_br_init_iov(bej_br* b, const bej_iov* seg, size_t nseg){
+    b->seg=seg; b->nseg=nseg; b->si=0; b->base=0; b->p=0; b->total=0;
+    for(size_t i=0;i<nseg;i++) b->total += seg[i].n;
+    b->d = nseg ? seg[0].d : NULL;
+    b->n = nseg ? seg[0].n : 0;
+}
+
+/* Slow path: move past the exhausted current segment; 0 at end of stream */
+static int br_next(bej_br* b){
+    while(b->p >= b->n){
+        if(!b->seg || b->si+1 >= b->nseg) return 0;
+        b->base += b->n;
+        b->si++; b->d = b->seg[b->si].d; b->n = b->seg[b->si].n; b->p = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Contiguous bytes available at the read position.
+ *
+ * Moves to the next segment first if the current one is exhausted.
+ * @param b Reader.
+ * @param ptr Output: pointer to the bytes (valid until the reader moves).
+ * @return Number of bytes readable through @p ptr (0 at end of stream).
+ */
+size_t bej_br_chunk(bej_br* b, const uint8_t** ptr){
+    if(b->p >= b->n && !br_next(b)){ *ptr = NULL; return 0; }
+    *ptr = b->d + b->p;
+    return b->n - b->p;
+}
 
 /**
  * @brief Read one byte from the reader.
@@ -20,7 +64,10 @@ void bej_br_init(bej_br* b, const uint8_t* d, size_t n){ b->d=d; b->n=n; b->p=0;
  * @param v Output: byte read.
  * @return 1 on success, 0 if out of bounds.
  */
-int  bej_br_u8 (bej_br* b, uint8_t* v){ if(b->p>=b->n) return 0; *v=b->d[b->p++]; return 1; }
+int  bej_br_u8 (bej_br* b, uint8_t* v){
+    if(b->p>=b->n && !br_next(b)) return 0;
+    *v=b->d[b->p++]; return 1;
+}
 
 /**
  * @brief Read a raw block of bytes.
@@ -29,28 +76,66 @@ int  bej_br_u8 (bej_br* b, uint8_t* v){ if(b->p>=b->n) return 0; *v=b->d[b->p++]
  * @param k Number of bytes to copy.
  * @return 1 on success, 0 on overflow.
  */
-int  bej_br_get(bej_br* b, uint8_t* dst, size_t k){ if(b->p+k>b->n) return 0; memcpy(dst, b->d+b->p, k); b->p+=k; return 1; }
+int  bej_br_get(bej_br* b, uint8_t* dst, size_t k){
+    if(k <= b->n - b->p){ memcpy(dst, b->d+b->p, k); b->p+=k; return 1; }
+    if(k > bej_br_left(b)) return 0;
+    while(k){
+        const uint8_t* s; size_t c = bej_br_chunk(b, &s);
+        if(c > k) c = k;
+        memcpy(dst, s, c); dst += c; b->p += c; k -= c;
+    }
+    return 1;
+}
+
+/**
+ * @brief Advance past a value of length @p L without reading it.
+ *
+ * Lengths come straight from the wire as 64-bit nnints; the check is done
+ * against the remaining byte count so it cannot overflow.
+ * @param b Reader.
+ * @param L Number of bytes to skip.
+ * @return 1 on success, 0 if fewer than @p L bytes remain.
+ */
+int  bej_br_skip(bej_br* b, uint64_t L){
+    if(L <= (uint64_t)(b->n - b->p)){ b->p += (size_t)L; return 1; }
+    if(L > (uint64_t)bej_br_left(b)) return 0;
+    size_t k = (size_t)L;
+    while(k){
+        const uint8_t* s; size_t c = bej_br_chunk(b, &s);
+        if(c > k) c = k;
+        b->p += c; k -= c;
+    }
+    return 1;
+}
 
 /**
- * @brief Seek to an absolute position within the buffer.
+ * @brief Seek to an absolute position within the stream (across all segments).
  * @param b Reader.
  * @param pos Absolute position.
  * @return 1 on success, 0 if out of range.
  */
-int  bej_br_seek(bej_br* b, size_t pos){ if(pos>b->n) return 0; b->p=pos; return 1; }
+int  bej_br_seek(bej_br* b, size_t pos){
+    if(!b->seg){ if(pos>b->n) return 0; b->p=pos; return 1; }
+    if(pos > b->total) return 0;
+    b->si=0; b->base=0;
+    while(b->si+1 < b->nseg && pos - b->base > b->seg[b->si].n){ b->base += b->seg[b->si].n; b->si++; }
+    b->d = b->seg[b->si].d; b->n = b->seg[b->si].n; b->p = pos - b->base;
+    return 1;
+}
 
 /**
- * @brief Get number of bytes remaining (n - p).
+ * @brief Get number of bytes remaining (over all segments).
  * @param b Reader.
  * @return Remaining byte count (may be zero).
  */
-int  bej_br_left(const bej_br* b){ return (int)(b->n - b->p); }
+size_t bej_br_left(const bej_br* b){ return b->total - b->base - b->p; }
 
 /**
  * @brief Read a BEJ non-negative integer (nnint) as per DSP0218.
  *
  * Encoding is: a single length byte N, followed by N bytes containing
- * a little-endian unsigned integer value.
+ * a little-endian unsigned integer value. Values wider than 64 bits
+ * (N > 8) are rejected.
  *
  * @param b Reader positioned at the start of an nnint.
  * @param out Output decoded value.
@@ -59,9 +144,16 @@ int  bej_br_left(const bej_br* b){ return (int)(b->n - b->p); }
 int bej_read_nnint(bej_br* b, uint64_t* out){
     uint8_t N; if(!bej_br_u8(b,&N)) return 0;
     uint64_t v=0;
-    if(b->p+N > b->n) return 0;
-    for(unsigned i=0;i<N;i++) v |= (uint64_t)b->d[b->p+i] << (8*i);
-    b->p += N;
+    if(N > 8) return 0;
+    if(N <= b->n - b->p){
+        for(unsigned i=0;i<N;i++) v |= (uint64_t)b->d[b->p+i] << (8*i);
+        b->p += N;
+    }else{
+        /* Straddles a segment boundary */
+        uint8_t t[8];
+        if(!bej_br_get(b, t, N)) return 0;
+        for(unsigned i=0;i<N;i++) v |= (uint64_t)t[i] << (8*i);
+    }
     *out = v;
     return 1;
 }
@@ -0,0 +1,29 @@
+#ifndef BEJ_CLI_ARGS_H_
+#define BEJ_CLI_ARGS_H_
+
+/**
+ * @file cli_args.h
+ * @brief Numeric argument parsing shared by the command-line tools (not part of the library).
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Unsigned decimal: digits only (no sign or blanks), whole string, in range */
+static inline int cli_parse_u64(const char* s, uint64_t* out){
+    if(*s<'0' || *s>'9') return 0;
+    char* end; errno=0;
+    unsigned long long v=strtoull(s,&end,10);
+    if(*end || errno==ERANGE) return 0;
+    *out=(uint64_t)v; return 1;
+}
+
+/* Cache budget in MiB, small enough to shift into bytes */
+static inline int cli_parse_mib(const char* s, size_t* out){
+    uint64_t v;
+    if(!cli_parse_u64(s,&v) || v > (SIZE_MAX >> 20)) return 0;
+    *out=(size_t)v; return 1;
+}
+
+#endif /* BEJ_CLI_ARGS_H_ */
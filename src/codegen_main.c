@@ -0,0 +1,403 @@
+/**
+ * @file codegen_main.c
+ * @brief Generate a schema-specialized C decoder from a dictionary.
+ *
+ * Usage: bej_codegen -s <schema.bin> -n <name> -o <out.c> [-H <out.h>]
+ *
+ * The generated source exports
+ *   int bej_<name>_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n);
+ *   int bej_<name>_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n);
+ *   int bej_<name>_decode_to_mem(const uint8_t* bej, size_t bej_n, char** out, size_t* out_n);
+ * and produces exactly the same JSON as the generic bej_decode_* functions
+ * with that dictionary. Each dictionary cluster becomes a function that
+ * switches on the member sequence number; keys are emitted from pre-quoted,
+ * pre-escaped literals and enum options from compiled-in tables, so the
+ * dictionary is never consulted at run time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bej.h"
+
+/* 64-bit file positioning (long is 32 bits on Windows) */
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+/* Simple file loader */
+static int load_file(const char* path, uint8_t** out, size_t* out_n){
+    *out=NULL; *out_n=0; FILE* f=fopen(path,"rb"); if(!f) return 0;
+    fseek64(f,0,SEEK_END); long long sz=(long long)ftell64(f); fseek64(f,0,SEEK_SET);
+    if(sz<=0 || (unsigned long long)sz>SIZE_MAX){ fclose(f); return 0; }
+    uint8_t* buf=(uint8_t*)malloc((size_t)sz);
+    if(!buf){ fclose(f); return 0; }
+    if(fread(buf,1,(size_t)sz,f)!=(size_t)sz){ free(buf); fclose(f); return 0; }
+    fclose(f); *out=buf; *out_n=(size_t)sz; return 1;
+}
+
+/* ---- clusters reachable from the root, in discovery order ---- */
+
+typedef struct {
+    bej_cluster* c;
+    int*         need_opts; /* referenced by a member: emit its option table */
+    size_t       n, cap;
+} cluster_list;
+
+static bej_cluster norm_cluster(const bej_dict* D, bej_cluster c){
+    if(c.start_idx >= D->n) c.count = 0;
+    if(c.count==0) c.start_idx = 0;
+    return c;
+}
+
+/* Index of cluster c, appending it if new; (size_t)-1 on allocation failure */
+static size_t cluster_id(cluster_list* L, bej_cluster c){
+    for(size_t i=0;i<L->n;i++) if(L->c[i].start_idx==c.start_idx && L->c[i].count==c.count) return i;
+    if(L->n==L->cap){
+        size_t cap = L->cap ? L->cap*2 : 64;
+        bej_cluster* nc = (bej_cluster*)realloc(L->c, cap*sizeof(*nc));
+        if(!nc) return (size_t)-1;
+        L->c = nc;
+        int* nn = (int*)realloc(L->need_opts, cap*sizeof(*nn));
+        if(!nn) return (size_t)-1;
+        L->need_opts = nn; L->cap = cap;
+    }
+    L->c[L->n] = c; L->need_opts[L->n] = 0;
+    return L->n++;
+}
+
+static uint32_t cluster_end(const bej_dict* D, bej_cluster c){
+    uint32_t end = c.start_idx + c.count;
+    return end > D->n ? (uint32_t)D->n : end;
+}
+
+/* 1 if seq already occurs in c before index i (the lookup resolves to the first) */
+static int seq_seen(const bej_dict* D, bej_cluster c, uint32_t i){
+    for(uint32_t k=c.start_idx;k<i;k++) if(D->ent[k].seq==D->ent[i].seq) return 1;
+    return 0;
+}
+
+/* ---- C literal output ---- */
+
+/* Write bytes as a C string literal (octal escapes keep it portable) */
+static void put_lit(FILE* f, const char* s, size_t n){
+    fputc('"', f);
+    for(size_t i=0;i<n;i++){
+        unsigned char c = (unsigned char)s[i];
+        if(c=='"' || c=='\\' || c=='?') fprintf(f, "\\%c", c);
+        else if(c>=0x20 && c<0x7F) fputc(c, f);
+        else fprintf(f, "\\%03o", c);
+    }
+    fputc('"', f);
+}
+
+/* JSON rendering of a key as bej_jw_key() writes it: "name": */
+static size_t render_key(char* out, const char* name){
+    size_t n = 0;
+    out[n++]='"';
+    for(const char* p=name;*p;p++){ if(*p=='"'||*p=='\\') out[n++]='\\'; out[n++]=*p; }
+    memcpy(out+n, "\": ", 3);
+    return n+3;
+}
+
+/* JSON rendering of a string as bej_jw_str() writes it */
+static size_t render_str(char* out, const char* s){
+    size_t n = 0;
+    out[n++]='"';
+    for(const char* p=s;*p;p++){
+        if(*p=='\n'){ out[n++]='\\'; out[n++]='n'; }
+        else { if(*p=='"'||*p=='\\') out[n++]='\\'; out[n++]=*p; }
+    }
+    out[n++]='"';
+    return n;
+}
+
+/* ---- generated runtime (schema independent) ---- */
+
+static const char* const g_prelude =
+"typedef struct { const char* s; size_t n; } gk_lit;\n"
+"typedef int (*gk_set_fn)(bej_jsonw* jw, bej_br* br);\n"
+"\n"
+"static int gk_tuple(bej_br* br, uint64_t* S, uint8_t* F, uint64_t* L){\n"
+"    return bej_read_nnint(br,S) && bej_br_u8(br,F) && bej_read_nnint(br,L);\n"
+"}\n"
+"\n"
+"static int gk_int(bej_jsonw* jw, bej_br* br, uint64_t L){\n"
+"    if(L > 8 || L > bej_br_left(br)) return 0;\n"
+"    uint64_t v=0;\n"
+"    for(size_t i=0;i<(size_t)L;i++) v |= (uint64_t)br->d[br->p+i] << (8*i);\n"
+"    br->p += (size_t)L;\n"
+"    bej_jw_int(jw, (long long)v);\n"
+"    return 1;\n"
+"}\n"
+"\n"
+"static int gk_str(bej_jsonw* jw, bej_br* br, uint64_t L){\n"
+"    if(L > bej_br_left(br)) return 0;\n"
+"    bej_jw_strn(jw, (const char*)br->d + br->p, (size_t)L);\n"
+"    br->p += (size_t)L;\n"
+"    return 1;\n"
+"}\n"
+"\n"
+"static int gk_enum(bej_jsonw* jw, bej_br* br, uint64_t L, const gk_lit* opts, size_t nopts){\n"
+"    bej_br val = *br;\n"
+"    uint64_t o; if(!bej_read_nnint(&val,&o)) return 0;\n"
+"    if(!bej_br_skip(br, L)) return 0;\n"
+"    if(o < nopts && opts[o].s) bej_jw_write(jw, opts[o].s, opts[o].n);\n"
+"    else bej_jw_write(jw, \"\\\"EnumOption\\\"\", 12);\n"
+"    return 1;\n"
+"}\n"
+"\n"
+"static int gk_array(bej_jsonw* jw, bej_br* br){\n"
+"    uint64_t cnt; if(!bej_read_nnint(br,&cnt)) return 0;\n"
+"    bej_jw_begin_arr(jw);\n"
+"    for(uint64_t k=0;k<cnt;k++){\n"
+"        uint64_t S, L; uint8_t F;\n"
+"        if(!gk_tuple(br,&S,&F,&L)) return 0;\n"
+"        if(k>0) bej_jw_write(jw, \", \", 2);\n"
+"        if((F>>4)==BEJ_FMT_INT){ if(!gk_int(jw,br,L)) return 0; }\n"
+"        else if((F>>4)==BEJ_FMT_STRING){ if(!gk_str(jw,br,L)) return 0; }\n"
+"        else { if(!bej_br_skip(br,L)) return 0; bej_jw_write(jw, \"null\", 4); }\n"
+"    }\n"
+"    bej_jw_end_arr(jw);\n"
+"    return 1;\n"
+"}\n"
+"\n"
+"/* Any format, with the member's child cluster and option table */\n"
+"static int gk_value(bej_jsonw* jw, bej_br* br, uint8_t fmt, uint64_t L,\n"
+"                    gk_set_fn set, const gk_lit* opts, size_t nopts){\n"
+"    switch(fmt){\n"
+"    case BEJ_FMT_INT:    return gk_int(jw,br,L);\n"
+"    case BEJ_FMT_STRING: return gk_str(jw,br,L);\n"
+"    case BEJ_FMT_SET:    return set(jw,br);\n"
+"    case BEJ_FMT_ARRAY:  return gk_array(jw,br);\n"
+"    case BEJ_FMT_ENUM:   return gk_enum(jw,br,L,opts,nopts);\n"
+"    default:\n"
+"        if(!bej_br_skip(br,L)) return 0;\n"
+"        bej_jw_write(jw, \"null\", 4);\n"
+"        return 1;\n"
+"    }\n"
+"}\n"
+"\n"
+"/* Member whose sequence number is not in the dictionary */\n"
+"static int gk_unknown(bej_jsonw* jw, bej_br* br, uint64_t seq, uint8_t fmt, uint64_t L, gk_set_fn empty){\n"
+"    char tmp[32]; snprintf(tmp,sizeof(tmp),\"seq_%llu\", (unsigned long long)seq);\n"
+"    bej_jw_key(jw, tmp);\n"
+"    return gk_value(jw, br, fmt, L, empty, NULL, 0);\n"
+"}\n\n";
+
+/* Value expression for a member described by entry de (fmt is the tuple format at run time) */
+static int emit_member(FILE* f, const bej_dict* D, cluster_list* L, const bej_dict_entry* de){
+    bej_cluster cc = norm_cluster(D, bej_dict_child_cluster(D, de));
+    size_t k = cluster_id(L, cc);
+    if(k==(size_t)-1) return 0;
+    /* Enum options come from the child cluster only when the entry declares one */
+    int opts = de->child_off && de->child_cnt && cc.count;
+    if(opts) L->need_opts[k] = 1;
+    char optargs[128];
+    if(opts) snprintf(optargs, sizeof(optargs), "opt_%zu, sizeof(opt_%zu)/sizeof(opt_%zu[0])", k, k, k);
+    else snprintf(optargs, sizeof(optargs), "NULL, 0");
+
+    /* The dictionary format gets a direct call; anything else goes through gk_value */
+    const char* fast = NULL; const char* fname = NULL; char fastbuf[192];
+    switch(de->fmt >> 4){
+    case BEJ_FMT_INT:    fname = "INT";    fast = "gk_int(jw,br,L)"; break;
+    case BEJ_FMT_STRING: fname = "STRING"; fast = "gk_str(jw,br,L)"; break;
+    case BEJ_FMT_ARRAY:  fname = "ARRAY";  fast = "gk_array(jw,br)"; break;
+    case BEJ_FMT_SET:
+        fname = "SET";
+        snprintf(fastbuf, sizeof(fastbuf), "set_%zu(jw,br)", k); fast = fastbuf; break;
+    case BEJ_FMT_ENUM:
+        fname = "ENUM";
+        snprintf(fastbuf, sizeof(fastbuf), "gk_enum(jw,br,L,%s)", optargs); fast = fastbuf; break;
+    default: break;
+    }
+    if(fast) fprintf(f, "            ok = fmt==BEJ_FMT_%s ? %s : gk_value(jw,br,fmt,L,set_%zu,%s);\n",
+                     fname, fast, k, optargs);
+    else fprintf(f, "            ok = gk_value(jw,br,fmt,L,set_%zu,%s);\n", k, optargs);
+    return 1;
+}
+
+static int emit_set_fn(FILE* f, const bej_dict* D, cluster_list* L, size_t k, size_t empty){
+    bej_cluster c = L->c[k];
+    uint32_t end = cluster_end(D, c);
+    fprintf(f, "/* Cluster %zu: entries [%u, %u) */\n", k, (unsigned)c.start_idx, (unsigned)end);
+    fprintf(f, "static int set_%zu(bej_jsonw* jw, bej_br* br){\n", k);
+    fprintf(f, "    uint64_t count; if(!bej_read_nnint(br,&count)) return 0;\n");
+    fprintf(f, "    bej_jw_begin_obj(jw);\n");
+    fprintf(f, "    for(uint64_t i=0;i<count;i++){\n");
+    fprintf(f, "        uint64_t S, L; uint8_t F;\n");
+    fprintf(f, "        if(!gk_tuple(br,&S,&F,&L)) return 0;\n");
+    fprintf(f, "        if(S & 1u){ if(!bej_br_skip(br,L)) return 0; continue; }\n");
+    fprintf(f, "        uint8_t fmt = (uint8_t)(F>>4);\n");
+    fprintf(f, "        int ok;\n");
+    fprintf(f, "        switch(S>>1){\n");
+    for(uint32_t i=c.start_idx;i<end;i++){
+        if(seq_seen(D, c, i)) continue;
+        const bej_dict_entry* de = bej_cluster_lookup_seq(D, c, D->ent[i].seq);
+        if(!de) continue;
+        const char* name = de->name_off ? bej_dict_name_at(D, de->name_off) : NULL;
+        char tmp[32]; if(!name){ snprintf(tmp,sizeof(tmp),"seq_%u",(unsigned)de->seq); name=tmp; }
+        char* key = (char*)malloc(2*strlen(name) + 4);
+        if(!key) return 0;
+        size_t kn = render_key(key, name);
+        fprintf(f, "        case %u:\n", (unsigned)de->seq);
+        fprintf(f, "            bej_jw_key_lit(jw, "); put_lit(f, key, kn); fprintf(f, ", %zu);\n", kn);
+        free(key);
+        if(!emit_member(f, D, L, de)) return 0;
+        fprintf(f, "            break;\n");
+    }
+    fprintf(f, "        default:\n");
+    fprintf(f, "            ok = gk_unknown(jw,br,S>>1,fmt,L,set_%zu);\n", empty);
+    fprintf(f, "            break;\n");
+    fprintf(f, "        }\n");
+    fprintf(f, "        if(!ok) return 0;\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    bej_jw_end_obj(jw);\n");
+    fprintf(f, "    return 1;\n");
+    fprintf(f, "}\n\n");
+    return 1;
+}
+
+static int emit_opt_table(FILE* f, const bej_dict* D, const cluster_list* L, size_t k){
+    bej_cluster c = L->c[k];
+    uint32_t end = cluster_end(D, c);
+    unsigned max = 0;
+    for(uint32_t i=c.start_idx;i<end;i++) if(D->ent[i].seq > max) max = D->ent[i].seq;
+    fprintf(f, "static const gk_lit opt_%zu[%u] = {\n", k, max+1);
+    for(unsigned o=0;o<=max;o++){
+        const bej_dict_entry* opt = bej_cluster_lookup_seq(D, c, o);
+        const char* name = (opt && opt->name_off) ? bej_dict_name_at(D, opt->name_off) : NULL;
+        if(!name){ fprintf(f, "    { NULL, 0 },\n"); continue; }
+        char* buf = (char*)malloc(2*strlen(name) + 2);
+        if(!buf) return 0;
+        size_t n = render_str(buf, name);
+        fprintf(f, "    { "); put_lit(f, buf, n); fprintf(f, ", %zu },\n", n);
+        free(buf);
+    }
+    fprintf(f, "};\n\n");
+    return 1;
+}
+
+static int emit_source(FILE* f, const char* schema, const char* name, const char* hdr, const bej_dict* D){
+    cluster_list L = {0};
+    size_t empty = cluster_id(&L, (bej_cluster){0,0});
+    size_t root = cluster_id(&L, norm_cluster(D, bej_dict_child_cluster(D, D->n>0 ? &D->ent[0] : NULL)));
+    if(empty==(size_t)-1 || root==(size_t)-1){ free(L.c); free(L.need_opts); return 0; }
+
+    /* Set functions go to a temporary stream: emitting them discovers the clusters
+       whose prototypes and option tables have to come first */
+    FILE* body = tmpfile();
+    if(!body){ free(L.c); free(L.need_opts); return 0; }
+    int ok = 1;
+    for(size_t k=0;k<L.n && ok;k++) ok = emit_set_fn(body, D, &L, k, empty);
+
+    fprintf(f, "/* Generated by bej_codegen from %s (%zu entries, dictionary id %016llx). Do not edit. */\n\n",
+            schema, D->n, (unsigned long long)D->id);
+    fprintf(f, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n#include \"bej.h\"\n");
+    if(hdr) fprintf(f, "#include \"%s\"\n", hdr);
+    fprintf(f, "\nconst uint64_t bej_%s_dict_id = 0x%016llxULL;\n\n", name, (unsigned long long)D->id);
+    fputs(g_prelude, f);
+    for(size_t k=0;k<L.n;k++) fprintf(f, "static int set_%zu(bej_jsonw* jw, bej_br* br);\n", k);
+    fputc('\n', f);
+    for(size_t k=0;k<L.n && ok;k++) if(L.need_opts[k]) ok = emit_opt_table(f, D, &L, k);
+
+    rewind(body);
+    char chunk[4096]; size_t r;
+    while((r = fread(chunk,1,sizeof(chunk),body)) > 0) fwrite(chunk,1,r,f);
+    fclose(body);
+
+    fprintf(f,
+"int bej_%s_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n){\n"
+"    if(!jw || !bej) return 0;\n"
+"    bej_br br; bej_br_init(&br, bej, bej_n);\n"
+"    if(!bej_br_seek(&br, 7)) return 0; /* bejEncoding header */\n"
+"    uint64_t S, L; uint8_t F;\n"
+"    if(!gk_tuple(&br,&S,&F,&L)) return 0;\n"
+"    if((F>>4) != BEJ_FMT_SET) return 0;\n"
+"    if(!set_%zu(jw, &br)) return 0;\n"
+"    bej_jw_write(jw, \"\\n\", 1);\n"
+"    return !jw->oom;\n"
+"}\n\n", name, root);
+    fprintf(f,
+"int bej_%s_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n){\n"
+"    if(!out) return 0;\n"
+"    bej_jsonw jw; bej_jw_init(&jw, out);\n"
+"    return bej_%s_decode_to_jsonw(&jw, bej, bej_n);\n"
+"}\n\n", name, name);
+    fprintf(f,
+"int bej_%s_decode_to_mem(const uint8_t* bej, size_t bej_n, char** out, size_t* out_n){\n"
+"    if(!out || !out_n) return 0;\n"
+"    *out=NULL; *out_n=0;\n"
+"    bej_jsonw jw; bej_jw_init_mem(&jw);\n"
+"    if(!bej_%s_decode_to_jsonw(&jw, bej, bej_n)){ free(jw.buf); return 0; }\n"
+"    *out=jw.buf; *out_n=jw.len;\n"
+"    return 1;\n"
+"}\n", name, name);
+    free(L.c); free(L.need_opts);
+    return ok;
+}
+
+static void emit_header(FILE* f, const char* schema, const char* name){
+    char guard[128]; size_t g=0;
+    for(const char* p="BEJ_"; *p; p++) guard[g++]=*p;
+    for(const char* p=name; *p && g<sizeof(guard)-4; p++) guard[g++]=(char)toupper((unsigned char)*p);
+    memcpy(guard+g, "_H_", 4);
+    fprintf(f, "/* Generated by bej_codegen from %s. Do not edit. */\n", schema);
+    fprintf(f, "#ifndef %s\n#define %s\n\n#include \"bej.h\"\n\n", guard, guard);
+    fprintf(f, "/** Identity (bej_dict::id) of the dictionary this decoder was generated from. */\n");
+    fprintf(f, "extern const uint64_t bej_%s_dict_id;\n\n", name);
+    fprintf(f, "int bej_%s_decode_to_jsonw(bej_jsonw* jw, const uint8_t* bej, size_t bej_n);\n", name);
+    fprintf(f, "int bej_%s_decode_to_json(FILE* out, const uint8_t* bej, size_t bej_n);\n", name);
+    fprintf(f, "int bej_%s_decode_to_mem(const uint8_t* bej, size_t bej_n, char** out, size_t* out_n);\n", name);
+    fprintf(f, "\n#endif /* %s */\n", guard);
+}
+
+static int valid_ident(const char* s){
+    if(!*s || isdigit((unsigned char)*s)) return 0;
+    for(;*s;s++) if(!isalnum((unsigned char)*s) && *s!='_') return 0;
+    return 1;
+}
+
+static const char* base_name(const char* p){
+    const char* b = p;
+    for(;*p;p++) if(*p=='/' || *p=='\\') b = p+1;
+    return b;
+}
+
+int main(int argc, char** argv){
+    const char* sp=NULL; const char* name=NULL; const char* op=NULL; const char* hp=NULL;
+    for(int i=1;i<argc;i++){
+        if(strcmp(argv[i],"-s")==0 && i+1<argc) sp=argv[++i];
+        else if(strcmp(argv[i],"-n")==0 && i+1<argc) name=argv[++i];
+        else if(strcmp(argv[i],"-o")==0 && i+1<argc) op=argv[++i];
+        else if(strcmp(argv[i],"-H")==0 && i+1<argc) hp=argv[++i];
+        else { sp=NULL; break; }
+    }
+    if(!sp||!name||!op){
+        fprintf(stderr,"Usage: %s -s <schema.bin> -n <name> -o <out.c> [-H <out.h>]\n", argv[0]);
+        return 1;
+    }
+    if(!valid_ident(name)){ fprintf(stderr,"ERROR: name must be a C identifier\n"); return 1; }
+
+    uint8_t* sb; size_t sn;
+    if(!load_file(sp,&sb,&sn)){ fprintf(stderr,"ERROR: open schema %s\n", sp); return 2; }
+    bej_dict D; if(!bej_dict_load(sb,sn,&D)){ fprintf(stderr,"ERROR: parse schema dict\n"); free(sb); return 2; }
+
+    int rc = 0;
+    FILE* fo=fopen(op,"wb");
+    if(!fo || !emit_source(fo, base_name(sp), name, hp ? base_name(hp) : NULL, &D)){ fprintf(stderr,"ERROR: write %s\n", op); rc=3; }
+    if(fo && fclose(fo)!=0 && !rc){ fprintf(stderr,"ERROR: write %s\n", op); rc=3; }
+    if(!rc && hp){
+        FILE* fh=fopen(hp,"wb");
+        if(fh) emit_header(fh, base_name(sp), name);
+        if(!fh || fclose(fh)!=0){ fprintf(stderr,"ERROR: write %s\n", hp); rc=3; }
+    }
+    if(rc) remove(op);
+    bej_dict_free(&D); free(sb);
+    return rc;
+}
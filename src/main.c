@@ -3,7 +3,13 @@
  * @brief CLI entrypoint: load files, decode BEJ to JSON using schema dictionary.
  *
  * Usage:
- *   bej_tool -s <schema.bin> -a <annotation.bin> -b <data.bej> -o <out.json>
+ *   bej_tool -s <schema.bin> -a <annotation.bin> -b <data.bej> [-b <data.bej> ...] [-c <MiB>]
+ *            [-F json|col|prom] [-m <map>] -o <out>
+ * Several -b inputs are decoded in order into the same output (batch mode);
+ * -c enables the decoded-output cache so repeated payloads are not decoded again
+ * (JSON output only);
+ * -F col writes one columnar file (one row per input) instead of JSON;
+ * -F prom writes the properties listed in the -m mapping file as OpenMetrics text.
  * Note: Annotation dictionary is opened/ignored. Supported: Set, Array, Int, String; Enum→String.
  */
 
@@ -11,12 +17,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include "bej.h"
+#include "cli_args.h"
+
+/* 64-bit file positioning (long is 32 bits on Windows) */
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
 
 /* Simple file loader */
 static int load_file(const char* path, uint8_t** out, size_t* out_n){
     *out=NULL; *out_n=0; FILE* f=fopen(path,"rb"); if(!f) return 0;
-    fseek(f,0,SEEK_END); long sz=ftell(f); fseek(f,0,SEEK_SET);
-    if(sz<=0){ fclose(f); return 0; }
+    fseek64(f,0,SEEK_END); long long sz=(long long)ftell64(f); fseek64(f,0,SEEK_SET);
+    if(sz<=0 || (unsigned long long)sz>SIZE_MAX){ fclose(f); return 0; }
     uint8_t* buf=(uint8_t*)malloc((size_t)sz);
     if(!buf){ fclose(f); return 0; }
     if(fread(buf,1,(size_t)sz,f)!=(size_t)sz){ free(buf); fclose(f); return 0; }
@@ -25,32 +41,91 @@ static int load_file(const char* path, uint8_t** out, size_t* out_n){
 
 static void usage(const char* a0){
     fprintf(stderr,
-        "Usage: %s -s <schema.bin> -a <annotation.bin> -b <data.bej> -o <out.json>\n"
+        "Usage: %s -s <schema.bin> -a <annotation.bin> -b <data.bej> [-b <data.bej> ...] [-c <MiB>]\n"
+        "          [-F json|col|prom] [-m <map>] -o <out>\n"
+        "  -c <MiB>  cache rendered output of byte-identical payloads (batch mode, JSON only)\n"
+        "  -F col    write a columnar file, one row per input, instead of JSON\n"
+        "  -F prom   write OpenMetrics samples for the properties mapped in -m <map>\n"
+        "            (with several -b inputs each sample is labelled payload=\"<file>\")\n"
         "Note: Annotation dictionary is opened/ignored. Supported: Set, Array, Int, String; Enum->String.\n", a0);
 }
 
 int main(int argc, char** argv){
-    const char* sp=NULL; const char* ap=NULL; const char* bp=NULL; const char* op=NULL;
+    const char* sp=NULL; const char* ap=NULL; const char* op=NULL;
+    const char** bps=(const char**)calloc((size_t)argc, sizeof(char*)); int nb=0;
+    const char* mp=NULL;
+    size_t cache_mib=0; int columnar=0, prom=0;
+    if(!bps) return 1;
     for(int i=1;i<argc;i++){
         if(strcmp(argv[i],"-s")==0 && i+1<argc) sp=argv[++i];
         else if(strcmp(argv[i],"-a")==0 && i+1<argc) ap=argv[++i];
-        else if(strcmp(argv[i],"-b")==0 && i+1<argc) bp=argv[++i];
+        else if(strcmp(argv[i],"-b")==0 && i+1<argc) bps[nb++]=argv[++i];
         else if(strcmp(argv[i],"-o")==0 && i+1<argc) op=argv[++i];
-        else { usage(argv[0]); return 1; }
+        else if(strcmp(argv[i],"-c")==0 && i+1<argc && cli_parse_mib(argv[i+1],&cache_mib)) i++;
+        else if(strcmp(argv[i],"-m")==0 && i+1<argc) mp=argv[++i];
+        else if(strcmp(argv[i],"-F")==0 && i+1<argc && strcmp(argv[i+1],"json")==0){ columnar=0; prom=0; i++; }
+        else if(strcmp(argv[i],"-F")==0 && i+1<argc && strcmp(argv[i+1],"col")==0){ columnar=1; prom=0; i++; }
+        else if(strcmp(argv[i],"-F")==0 && i+1<argc && strcmp(argv[i+1],"prom")==0){ columnar=0; prom=1; i++; }
+        else { usage(argv[0]); free(bps); return 1; }
     }
-    if(!sp||!ap||!bp||!op){ usage(argv[0]); return 1; }
+    if(!sp||!ap||!nb||!op||(prom && !mp)||(cache_mib && (columnar||prom))){ usage(argv[0]); free(bps); return 1; }
 
-    uint8_t *sbuf=NULL,*bbuf=NULL; size_t sn=0,bn=0;
-    if(!load_file(sp,&sbuf,&sn)){ fprintf(stderr,"ERROR: open schema %s\n", sp); return 2; }
-    FILE* fa=fopen(ap,"rb"); if(!fa){ fprintf(stderr,"ERROR: open annotation %s\n", ap); free(sbuf); return 3; } fclose(fa);
-    if(!load_file(bp,&bbuf,&bn)){ fprintf(stderr,"ERROR: open bej %s\n", bp); free(sbuf); return 4; }
+    uint8_t *sbuf=NULL; size_t sn=0;
+    if(!load_file(sp,&sbuf,&sn)){ fprintf(stderr,"ERROR: open schema %s\n", sp); free(bps); return 2; }
+    FILE* fa=fopen(ap,"rb"); if(!fa){ fprintf(stderr,"ERROR: open annotation %s\n", ap); free(sbuf); free(bps); return 3; } fclose(fa);
 
-    bej_dict D; if(!bej_dict_load(sbuf,sn,&D)){ fprintf(stderr,"ERROR: parse schema dict\n"); free(sbuf); free(bbuf); return 5; }
+    bej_dict D; if(!bej_dict_load(sbuf,sn,&D)){ fprintf(stderr,"ERROR: parse schema dict\n"); free(sbuf); free(bps); return 5; }
 
-    FILE* fo=fopen(op,"wb"); if(!fo){ fprintf(stderr,"ERROR: open out %s\n", op); free(sbuf); free(bbuf); bej_dict_free(&D); return 6; }
-    int ok = bej_decode_to_json(fo, bbuf, bn, &D);
-    fclose(fo);
-    free(sbuf); free(bbuf); bej_dict_free(&D);
-    if(!ok){ fprintf(stderr,"ERROR: decode\n"); remove(op); return 7; }
-    return 0;
+    FILE* fo=fopen(op,"wb"); if(!fo){ fprintf(stderr,"ERROR: open out %s\n", op); free(sbuf); bej_dict_free(&D); free(bps); return 6; }
+    bej_cache* cache = cache_mib ? bej_cache_new(cache_mib << 20) : NULL;
+    bej_colset cols;
+    bej_prom* pm = NULL;
+    int rc=0;
+    if(columnar && !bej_colset_init(&cols, &D)){ fprintf(stderr,"ERROR: out of memory\n"); rc=8; }
+    if(prom){
+        uint8_t* mbuf=NULL; size_t mn=0, line=0;
+        if(!load_file(mp,&mbuf,&mn)){ fprintf(stderr,"ERROR: open map %s\n", mp); rc=10; }
+        else if(!(pm = bej_prom_new(&D, (const char*)mbuf, mn, &line))){ fprintf(stderr,"ERROR: map %s line %zu\n", mp, line); rc=10; }
+        free(mbuf);
+    }
+    for(int k=0;k<nb && !rc;k++){
+        uint8_t* bbuf=NULL; size_t bn=0;
+        if(!load_file(bps[k],&bbuf,&bn)){ fprintf(stderr,"ERROR: open bej %s\n", bps[k]); rc=4; break; }
+        char lab[1024] = "";
+        if(prom && nb > 1){
+            /* payload="<file>" with the label value escaped */
+            size_t q = 0; q += (size_t)snprintf(lab, sizeof(lab), "payload=\"");
+            for(const char* c=bps[k]; *c && q+4<sizeof(lab); c++){
+                if(*c=='\\' || *c=='"'){ lab[q++]='\\'; lab[q++]=*c; }
+                else if(*c=='\n'){ lab[q++]='\\'; lab[q++]='n'; }
+                else lab[q++]=*c;
+            }
+            lab[q++]='"'; lab[q]=0;
+        }
+        int ok = columnar ? bej_colset_add(&cols, bbuf, bn)
+               : prom ? bej_prom_add(pm, bbuf, bn, lab)
+               : cache ? bej_cache_decode_to_json(cache, fo, bbuf, bn, &D)
+                       : bej_decode_to_json(fo, bbuf, bn, &D);
+        free(bbuf);
+        if(!ok){ fprintf(stderr,"ERROR: decode %s\n", bps[k]); rc=7; }
+    }
+    if(columnar && rc!=8){
+        if(!rc && !bej_colset_write(&cols, fo)){ fprintf(stderr,"ERROR: write %s\n", op); rc=9; }
+        bej_colset_free(&cols);
+    }
+    if(pm){
+        if(!rc && !bej_prom_write(pm, fo)){ fprintf(stderr,"ERROR: write %s\n", op); rc=9; }
+        bej_prom_free(pm);
+    }
+    if(fclose(fo)!=0 && !rc){ fprintf(stderr,"ERROR: write %s\n", op); rc=9; }
+    if(cache){
+        bej_cache_stats st; bej_cache_get_stats(cache, &st);
+        fprintf(stderr,"cache: %llu hits, %llu misses, %llu evictions, %llu entries, %llu bytes\n",
+                (unsigned long long)st.hits, (unsigned long long)st.misses, (unsigned long long)st.evictions,
+                (unsigned long long)st.entries, (unsigned long long)st.bytes);
+        bej_cache_free(cache);
+    }
+    free(sbuf); bej_dict_free(&D); free(bps);
+    if(rc) remove(op);
+    return rc;
 }
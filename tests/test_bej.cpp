@@ -36,7 +36,7 @@ TEST(Min, NNIntBasic){
         std::vector<uint8_t> b = {0x01,0x00}; // 0
         bej_br br; bej_br_init(&br, b.data(), b.size());
         uint64_t val=123; ASSERT_TRUE(bej_read_nnint(&br,&val)); EXPECT_EQ(val, 0u);
-        EXPECT_EQ(bej_br_left(&br), 0);
+        EXPECT_EQ(bej_br_left(&br), 0u);
     }
     {
         std::vector<uint8_t> b = {0x02,0x2C,0x01}; // 300
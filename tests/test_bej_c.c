@@ -1,6 +1,11 @@
 /* tests/test_bej_c.c
  * Minimal C unit tests for BEJ, no external deps, GCC 6.x friendly.
- * Covers: nnint decoding (two cases) and dictionary load + cluster lookup.
+ * Covers: nnint decoding (two cases), dictionary load + cluster lookup,
+ * payload deltas (merge patch / JSON patch), the decoded-output cache,
+ * property predicates, the payload archive, 64-bit length/offset handling,
+ * the columnar sink, pre-rendered dictionary keys, the scatter-gather
+ * reader, exact-size (two-pass) rendering, bulk decoding of Integer
+ * array runs and the OpenMetrics exporter.
  */
 
 #include <stdio.h>
@@ -63,6 +68,86 @@ static void push_cstr(uint8_t** p, size_t* n, const char* s){
     push_u8(p,n,0);
 }
 
+/* One 10-byte dictionary entry at index i (child index < 0 means no children). */
+static void put_entry(uint8_t* dict, size_t entries_ofs, int i, uint8_t fmt, uint16_t seq,
+                      int child_idx, uint16_t child_cnt, const char* name, uint16_t name_off){
+    size_t q = entries_ofs + (size_t)i*10;
+    uint16_t child_off = child_idx<0 ? 0 : (uint16_t)(entries_ofs + (size_t)child_idx*10);
+    dict[q+0] = fmt;
+    dict[q+1] = (uint8_t)(seq & 0xFF); dict[q+2] = (uint8_t)(seq>>8);
+    dict[q+3] = (uint8_t)(child_off & 0xFF); dict[q+4] = (uint8_t)(child_off>>8);
+    dict[q+5] = (uint8_t)(child_cnt & 0xFF); dict[q+6] = (uint8_t)(child_cnt>>8);
+    dict[q+7] = (uint8_t)(strlen(name)+1);
+    dict[q+8] = (uint8_t)(name_off & 0xFF); dict[q+9] = (uint8_t)(name_off>>8);
+}
+
+/*
+ * Small schema used by the decoder-level tests:
+ *   Root { Count:int(0), Name:string(1), Loc:set(2){ Slot:int(0) }, State:enum(3){ Enabled, Disabled } }
+ */
+static size_t build_test_dict(uint8_t* dict){
+    static const char* names[] = { "Root","Count","Name","Loc","State","Slot","Enabled","Disabled" };
+    size_t n=0; uint8_t* p=dict;
+    push_u8(&p,&n,0x01); push_u8(&p,&n,0x00);
+    push_u16le(&p,&n,8);
+    push_u32le(&p,&n,0); push_u32le(&p,&n,0);
+    size_t entries_ofs = n;
+    for(int i=0;i<80;i++) push_u8(&p,&n,0x00);
+    uint16_t off[8];
+    for(int i=0;i<8;i++){ off[i]=(uint16_t)n; push_cstr(&p,&n,names[i]); }
+    put_entry(dict,entries_ofs,0,0x00,0, 1,4,names[0],off[0]);
+    put_entry(dict,entries_ofs,1,0x30,0,-1,0,names[1],off[1]);
+    put_entry(dict,entries_ofs,2,0x50,1,-1,0,names[2],off[2]);
+    put_entry(dict,entries_ofs,3,0x00,2, 5,1,names[3],off[3]);
+    put_entry(dict,entries_ofs,4,0x40,3, 6,2,names[4],off[4]);
+    put_entry(dict,entries_ofs,5,0x30,0,-1,0,names[5],off[5]);
+    put_entry(dict,entries_ofs,6,0x00,0,-1,0,names[6],off[6]);
+    put_entry(dict,entries_ofs,7,0x00,1,-1,0,names[7],off[7]);
+    return n;
+}
+
+static void push_tuple(uint8_t** p, size_t* n, uint16_t seq, uint8_t fmt, const uint8_t* v, size_t vn){
+    push_nnint(p,n,(uint64_t)seq<<1);
+    push_u8(p,n,(uint8_t)(fmt<<4));
+    push_nnint(p,n,vn);
+    for(size_t i=0;i<vn;i++) push_u8(p,n,v[i]);
+}
+
+/* Payload for the test schema; name==NULL omits Name. */
+static size_t build_test_payload(uint8_t* out, uint8_t count, const char* name, uint8_t slot, uint8_t state){
+    uint8_t loc[16], root[128], v[64];
+    size_t ln=0, rn=0, vn=0, n=0; uint8_t* p;
+
+    p=loc; push_nnint(&p,&ln,1); push_tuple(&p,&ln,0,BEJ_FMT_INT,&slot,1);
+
+    p=root; push_nnint(&p,&rn, name ? 4 : 3);
+    push_tuple(&p,&rn,0,BEJ_FMT_INT,&count,1);
+    if(name){ p=v; push_cstr(&p,&vn,name); p=root; push_tuple(&p,&rn,1,BEJ_FMT_STRING,v,vn); }
+    push_tuple(&p,&rn,2,BEJ_FMT_SET,loc,ln);
+    vn=0; p=v; push_nnint(&p,&vn,state); p=root; push_tuple(&p,&rn,3,BEJ_FMT_ENUM,v,vn);
+
+    p=out;
+    push_u32le(&p,&n,0xF1F0F000u); push_u16le(&p,&n,0); push_u8(&p,&n,0);
+    push_tuple(&p,&n,0,BEJ_FMT_SET,root,rn);
+    return n;
+}
+
+/* Read a tmpfile back and drop whitespace outside JSON strings. */
+static void slurp_compact(FILE* f, char* out, size_t cap){
+    size_t k=0; int in_str=0, esc=0, ch;
+    rewind(f);
+    while((ch=fgetc(f))!=EOF && k+1<cap){
+        if(in_str){
+            if(esc) esc=0; else if(ch=='\\') esc=1; else if(ch=='"') in_str=0;
+        }else{
+            if(ch==' '||ch=='\n') continue;
+            if(ch=='"') in_str=1;
+        }
+        out[k++]=(char)ch;
+    }
+    out[k]=0;
+}
+
 /* --------------------- tests --------------------- */
 
 /* 1) nnint: 0 и 300 */
@@ -149,12 +234,557 @@ TEST(test_dict_load_lookup){
     bej_dict_free(&D);
 }
 
+/* 3) delta: merge patch and JSON patch between two polls */
+TEST(test_delta_patch){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+
+    uint8_t a[160], b[160], c[160];
+    size_t an = build_test_payload(a, 7, "dimm0", 1, 0);
+    size_t bn = build_test_payload(b, 7, "dimm0", 3, 1);
+    size_t cn = build_test_payload(c, 8, NULL, 1, 0);
+    char got[512];
+
+    FILE* f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, a, an, a, an, &D, BEJ_PATCH_MERGE)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "{}")==0);
+
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, a, an, b, bn, &D, BEJ_PATCH_MERGE)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "{\"Loc\":{\"Slot\":3},\"State\":\"Disabled\"}")==0);
+
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, a, an, c, cn, &D, BEJ_PATCH_MERGE)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "{\"Count\":8,\"Name\":null}")==0);
+
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, a, an, c, cn, &D, BEJ_PATCH_JSON)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "[{\"op\":\"replace\",\"path\":\"/Count\",\"value\":8},"
+                         "{\"op\":\"remove\",\"path\":\"/Name\"}]")==0);
+
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, c, cn, b, bn, &D, BEJ_PATCH_JSON)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "[{\"op\":\"replace\",\"path\":\"/Count\",\"value\":7},"
+                         "{\"op\":\"add\",\"path\":\"/Name\",\"value\":\"dimm0\"},"
+                         "{\"op\":\"replace\",\"path\":\"/Loc/Slot\",\"value\":3},"
+                         "{\"op\":\"replace\",\"path\":\"/State\",\"value\":\"Disabled\"}]")==0);
+
+    /* Count changes to a Boolean, which renders as null: a merge patch would
+     * read that as a removal, so only the JSON Patch form succeeds */
+    uint8_t root[64], d[96], t = 1, one[2] = { 1, 1 };
+    size_t rn = 0, dn2 = 0; uint8_t* q = root;
+    push_nnint(&q,&rn,2); push_tuple(&q,&rn,0,0x7,&t,1); push_tuple(&q,&rn,3,BEJ_FMT_ENUM,one,2);
+    q = d; push_u32le(&q,&dn2,0xF1F0F000u); push_u16le(&q,&dn2,0); push_u8(&q,&dn2,0);
+    push_tuple(&q,&dn2,0,BEJ_FMT_SET,root,rn);
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, b, bn, d, dn2, &D, BEJ_PATCH_MERGE)==0);
+    MU_CHECK(ftell(f)==0);   /* failed deltas write nothing */
+    fclose(f);
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, b, bn, d, dn2, &D, BEJ_PATCH_JSON)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "[{\"op\":\"replace\",\"path\":\"/Count\",\"value\":null},"
+                         "{\"op\":\"remove\",\"path\":\"/Name\"},{\"op\":\"remove\",\"path\":\"/Loc\"}]")==0);
+
+    /* truncated current payload is rejected */
+    f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_delta_to_json(f, a, an, b, bn-2, &D, BEJ_PATCH_MERGE)==0);
+    MU_CHECK(ftell(f)==0);
+    fclose(f);
+
+    bej_dict_free(&D);
+}
+
+/* 4) cache: hits return the decoder's exact bytes; LRU eviction under a tight limit */
+TEST(test_cache_lru){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    MU_ASSERT(D.id!=0);
+
+    uint8_t a[160], b[160];
+    size_t an = build_test_payload(a, 7, "dimm0", 1, 0);
+    size_t bn = build_test_payload(b, 9, "dimm1", 2, 1);
+
+    char* ref; size_t ref_n;
+    MU_ASSERT(bej_decode_to_mem(a, an, &D, &ref, &ref_n)==1);
+    FILE* f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_decode_to_json(f, a, an, &D)==1);
+    MU_CHECK((size_t)ftell(f)==ref_n);
+    fclose(f);
+
+    bej_cache* c = bej_cache_new(1<<20); MU_ASSERT(c!=NULL);
+    const char* js; size_t jn; bej_cache_stats st;
+    MU_CHECK(bej_cache_decode(c, a, an, &D, &js, &jn)==1);
+    MU_CHECK(jn==ref_n && memcmp(js, ref, jn)==0);
+    MU_CHECK(bej_cache_decode(c, a, an, &D, &js, &jn)==1);
+    MU_CHECK(jn==ref_n && memcmp(js, ref, jn)==0);
+    MU_CHECK(bej_cache_decode(c, b, bn, &D, &js, &jn)==1);
+    bej_cache_get_stats(c, &st);
+    MU_CHECK(st.hits==1 && st.misses==2 && st.entries==2 && st.evictions==0);
+    MU_CHECK(bej_cache_decode(c, a, bn-2, &D, &js, &jn)==0); /* malformed: not cached */
+    bej_cache_free(c);
+
+    /* Room for one entry only: alternating payloads always evict */
+    c = bej_cache_new(ref_n + an + 256); MU_ASSERT(c!=NULL);
+    MU_CHECK(bej_cache_decode(c, a, an, &D, &js, &jn)==1);
+    MU_CHECK(bej_cache_decode(c, b, bn, &D, &js, &jn)==1);
+    MU_CHECK(bej_cache_decode(c, a, an, &D, &js, &jn)==1);
+    MU_CHECK(jn==ref_n && memcmp(js, ref, jn)==0);
+    bej_cache_get_stats(c, &st);
+    MU_CHECK(st.hits==0 && st.misses==3 && st.evictions==2 && st.entries==1);
+    MU_CHECK(st.bytes <= ref_n + an + 256);
+    bej_cache_free(c);
+
+    free(ref);
+    bej_dict_free(&D);
+}
+
+/* 5) predicates: path resolution and evaluation without decoding */
+TEST(test_pred_eval){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    uint8_t a[160]; size_t an = build_test_payload(a, 7, "dimm0", 3, 1);
+    uint8_t b[160]; size_t bn = build_test_payload(b, 7, NULL, 3, 1);
+    bej_pred P;
+
+    MU_CHECK(bej_pred_compile(&P, &D, "Loc/Slot=3")==1 && bej_pred_eval(&P, a, an)==1);
+    MU_CHECK(bej_pred_compile(&P, &D, "Loc/Slot<3")==1 && bej_pred_eval(&P, a, an)==0);
+    MU_CHECK(bej_pred_compile(&P, &D, "Count>=7")==1 && bej_pred_eval(&P, a, an)==1);
+    MU_CHECK(bej_pred_compile(&P, &D, "Name=dimm0")==1 && bej_pred_eval(&P, a, an)==1);
+    MU_CHECK(bej_pred_eval(&P, b, bn)==0); /* absent property never matches */
+    MU_CHECK(bej_pred_compile(&P, &D, "Name!=dimm1")==1 && bej_pred_eval(&P, a, an)==1);
+    MU_CHECK(bej_pred_compile(&P, &D, "State=Disabled")==1 && bej_pred_eval(&P, a, an)==1);
+    MU_CHECK(bej_pred_compile(&P, &D, "State=Enabled")==1 && bej_pred_eval(&P, a, an)==0);
+    MU_CHECK(bej_pred_eval(&P, a, 9)==-1);
+
+    /* 8-byte Count with the top bit set reads as a negative number, like the decoder renders it */
+    uint8_t neg[8] = { 0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF }, root[32], c[64];
+    size_t rn = 0, cn = 0; uint8_t* q = root;
+    push_nnint(&q,&rn,1); push_tuple(&q,&rn,0,BEJ_FMT_INT,neg,8);
+    q = c; push_u32le(&q,&cn,0xF1F0F000u); push_u16le(&q,&cn,0); push_u8(&q,&cn,0);
+    push_tuple(&q,&cn,0,BEJ_FMT_SET,root,rn);
+    MU_CHECK(bej_pred_compile(&P, &D, "Count=-2")==1 && bej_pred_eval(&P, c, cn)==1);
+    MU_CHECK(bej_pred_compile(&P, &D, "Count<0")==1 && bej_pred_eval(&P, c, cn)==1);
+
+    MU_CHECK(bej_pred_compile(&P, &D, "Loc/Nope=1")==0);
+    MU_CHECK(bej_pred_compile(&P, &D, "State=Bogus")==0);
+    MU_CHECK(bej_pred_compile(&P, &D, "Name<abc")==0);
+    MU_CHECK(bej_pred_compile(&P, &D, "Count=x")==0);
+    bej_dict_free(&D);
+}
+
+/* 6) archive: append twice, reopen via index, recover from a lost footer */
+TEST(test_arc_roundtrip){
+    const char* path = "test_bej_arc.tmp";
+    uint8_t a[160], b[160];
+    size_t an = build_test_payload(a, 7, "dimm0", 1, 0);
+    size_t bn = build_test_payload(b, 9, NULL, 2, 1);
+    remove(path);
+
+    bej_arc_writer W;
+    MU_ASSERT(bej_arc_writer_open(&W, path)==1);
+    MU_CHECK(bej_arc_writer_add(&W, 100, "/m/0", 42, a, an)==1);
+    MU_ASSERT(bej_arc_writer_close(&W)==1);
+    MU_ASSERT(bej_arc_writer_open(&W, path)==1);
+    MU_CHECK(bej_arc_writer_add(&W, 200, "/m/1", 42, b, bn)==1);
+    MU_ASSERT(bej_arc_writer_close(&W)==1);
+
+    bej_arc A; size_t n; const uint8_t* p; const char* r;
+    MU_ASSERT(bej_arc_open(&A, path)==1);
+    MU_CHECK(A.n==2 && A.recovered==0);
+    p = bej_arc_payload(&A, 1, &n);
+    MU_CHECK(p && n==bn && memcmp(p, b, bn)==0);
+    r = bej_arc_resource(&A, 0, &n);
+    MU_CHECK(r && n==4 && memcmp(r, "/m/0", 4)==0);
+    MU_CHECK(A.ent[1].ts==200 && A.ent[1].dict_id==42);
+    MU_CHECK(bej_arc_payload(&A, 2, &n)==NULL);
+    size_t whole = A.size;
+    bej_arc_close(&A);
+
+    /* Chop off the footer: records are found by scanning */
+    FILE* f = fopen(path, "rb"); MU_ASSERT(f!=NULL);
+    uint8_t* buf = (uint8_t*)malloc(whole); MU_ASSERT(buf!=NULL);
+    MU_CHECK(fread(buf, 1, whole, f)==whole); fclose(f);
+    f = fopen(path, "wb"); MU_ASSERT(f!=NULL);
+    fwrite(buf, 1, whole-30, f); fclose(f);
+    free(buf);
+    MU_ASSERT(bej_arc_open(&A, path)==1);
+    MU_CHECK(A.recovered==1 && A.n==2);
+    p = bej_arc_payload(&A, 0, &n);
+    MU_CHECK(p && n==an && memcmp(p, a, an)==0);
+    bej_arc_close(&A);
+
+    /* Appending to a recovered archive restores the index */
+    MU_ASSERT(bej_arc_writer_open(&W, path)==1);
+    MU_CHECK(bej_arc_writer_add(&W, 300, "/m/0", 42, a, an)==1);
+    MU_ASSERT(bej_arc_writer_close(&W)==1);
+    MU_ASSERT(bej_arc_open(&A, path)==1);
+    MU_CHECK(A.recovered==0 && A.n==3 && A.ent[2].ts==300);
+    bej_arc_close(&A);
+    remove(path);
+
+#if !defined(_WIN32) && SIZE_MAX > 0xFFFFFFFFu
+    /* Appends past 4 GiB: an empty archive whose index sits above the old
+     * 32-bit resource-offset limit (sparse file, nothing in between) */
+    uint64_t io = 0x100000000ull + 64;
+    uint8_t hdr[8] = { 'B','E','J','A', 1,0, 0,0 }, tr[24] = { 0 };
+    for(int i=0;i<8;i++) tr[i] = (uint8_t)(io >> (8*i));
+    tr[16] = 1; memcpy(tr+20, "BEJI", 4);
+    f = fopen(path, "wb"); MU_ASSERT(f!=NULL);
+    int made = fwrite(hdr,1,8,f)==8 && fseeko(f, (off_t)io, SEEK_SET)==0 && fwrite(tr,1,24,f)==24;
+    if(fclose(f)!=0) made = 0;
+    if(!made){ fprintf(stdout, "  (skipped >4 GiB append: cannot create sparse file)\n"); remove(path); return; }
+    MU_ASSERT(bej_arc_writer_open(&W, path)==1);
+    MU_CHECK(bej_arc_writer_add(&W, 400, "/m/far", 42, a, an)==1);
+    MU_ASSERT(bej_arc_writer_close(&W)==1);
+    MU_ASSERT(bej_arc_open(&A, path)==1);
+    MU_CHECK(A.recovered==0 && A.n==1 && A.ent[0].res_off==io + 34);
+    r = bej_arc_resource(&A, 0, &n);
+    MU_CHECK(r && n==6 && memcmp(r, "/m/far", 6)==0);
+    p = bej_arc_payload(&A, 0, &n);
+    MU_CHECK(p && n==an && memcmp(p, a, an)==0);
+    bej_arc_close(&A);
+    remove(path);
+#endif
+}
+
+/* 7) lengths: overflow-safe skips, nnint width, lengths past INT_MAX are rejected, not truncated */
+TEST(test_large_lengths){
+    uint8_t nn[10] = {0x09,1,2,3,4,5,6,7,8,9};
+    bej_br br; bej_br_init(&br, nn, sizeof(nn));
+    uint64_t v;
+    MU_CHECK(bej_read_nnint(&br,&v)==0);            /* 9-byte nnint does not fit in 64 bits */
+    bej_br_init(&br, nn, sizeof(nn));
+    MU_CHECK(bej_br_skip(&br, UINT64_MAX)==0);
+    MU_CHECK(bej_br_skip(&br, 10)==1 && bej_br_left(&br)==0);
+
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    /* Root Set whose only member is an annotation claiming 2^32+1 bytes */
+    uint8_t p[64]; size_t n=0; uint8_t* q=p;
+    push_u32le(&q,&n,0xF1F0F000u); push_u16le(&q,&n,0); push_u8(&q,&n,0);
+    push_nnint(&q,&n,0); push_u8(&q,&n,0x00); push_nnint(&q,&n,20);
+    push_nnint(&q,&n,1);
+    push_nnint(&q,&n,(1u<<1)|1u); push_u8(&q,&n,0x50); push_nnint(&q,&n,((uint64_t)1<<32)+1);
+    push_u8(&q,&n,'x');
+    FILE* f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_decode_to_json(f, p, n, &D)==0);
+    fclose(f);
+    bej_dict_free(&D);
+}
+
+/* 8) dictionary larger than 64 KiB: local wide entries with 32-bit offsets */
+TEST(test_dict_wide){
+    enum { NPROP = 6000 };
+    size_t esz = BEJ_DICT_WIDE_ENTRY_N, cap = 12 + (NPROP+1)*esz + (NPROP+1)*16;
+    uint8_t* d = (uint8_t*)calloc(1, cap); MU_ASSERT(d!=NULL);
+    size_t n=0; uint8_t* p=d;
+    push_u8(&p,&n,0x01); push_u8(&p,&n,BEJ_DICT_FLAG_LOCAL_WIDE);
+    push_u16le(&p,&n,NPROP+1);
+    push_u32le(&p,&n,0); push_u32le(&p,&n,0);
+    size_t eo = n; n += (NPROP+1)*esz;
+    for(uint32_t i=0;i<=NPROP;i++){
+        char name[16]; int k = i ? snprintf(name,sizeof(name),"Property%05u",(unsigned)(i-1)) : snprintf(name,sizeof(name),"Root");
+        uint32_t off = (uint32_t)n; push_cstr(&p,&n,name);
+        uint8_t* e = d + eo + i*esz;
+        uint32_t child = i ? 0 : (uint32_t)(eo + esz);
+        uint16_t seq = (uint16_t)(i ? i-1 : 0), cnt = (uint16_t)(i ? 0 : NPROP);
+        e[0] = i ? 0x30 : 0x00;
+        e[1] = (uint8_t)seq; e[2] = (uint8_t)(seq>>8);
+        for(int b=0;b<4;b++) e[3+b] = (uint8_t)(child>>(8*b));
+        e[7] = (uint8_t)cnt; e[8] = (uint8_t)(cnt>>8);
+        e[9] = (uint8_t)(k+1);
+        for(int b=0;b<4;b++) e[10+b] = (uint8_t)(off>>(8*b));
+    }
+    MU_CHECK(n > 0x10000);
+
+    bej_dict D;
+    MU_CHECK(bej_dict_load(d, n, &D)==0);   /* reserved DSP0218 bit: external loads refuse it */
+    MU_ASSERT(bej_dict_load_local(d, n, &D)==1);
+    bej_cluster rootc = bej_dict_child_cluster(&D, &D.ent[0]);
+    MU_CHECK(rootc.start_idx==1 && rootc.count==NPROP);
+    const bej_dict_entry* e = bej_cluster_lookup_seq(&D, rootc, NPROP-1);
+    MU_ASSERT(e!=NULL && e->name_off > 0xFFFF);
+    MU_CHECK(strcmp(bej_dict_name_at(&D, e->name_off), "Property05999")==0);
+
+    /* { "Property05999": 5 } */
+    uint8_t pl[32]; size_t pn=0; uint8_t* q=pl; uint8_t five=5;
+    push_u32le(&q,&pn,0xF1F0F000u); push_u16le(&q,&pn,0); push_u8(&q,&pn,0);
+    push_nnint(&q,&pn,0); push_u8(&q,&pn,0x00); push_nnint(&q,&pn,8);
+    push_nnint(&q,&pn,1); push_tuple(&q,&pn,NPROP-1,BEJ_FMT_INT,&five,1);
+    char got[128];
+    FILE* f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_decode_to_json(f, pl, pn, &D)==1);
+    slurp_compact(f, got, sizeof(got)); fclose(f);
+    MU_CHECK(strcmp(got, "{\"Property05999\":5}")==0);
+
+    bej_dict_free(&D);
+    free(d);
+}
+
+TEST(test_colset){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    uint8_t a[160]; size_t an = build_test_payload(a, 7, "dimm0", 3, 1);
+    uint8_t b[160]; size_t bn = build_test_payload(b, 9, NULL, 4, 5);   /* no Name, unknown State */
+
+    bej_colset C; MU_ASSERT(bej_colset_init(&C, &D)==1);
+    MU_CHECK(C.ncol==4);
+    const bej_col* cnt  = bej_colset_find(&C, "Count");
+    const bej_col* name = bej_colset_find(&C, "Name");
+    const bej_col* slot = bej_colset_find(&C, "Loc/Slot");
+    const bej_col* st   = bej_colset_find(&C, "State");
+    MU_ASSERT(cnt && name && slot && st);
+    MU_CHECK(cnt->fmt==BEJ_FMT_INT && name->fmt==BEJ_FMT_STRING && st->fmt==BEJ_FMT_ENUM);
+    MU_CHECK(st->nopts==2 && strcmp(st->opts[1],"Disabled")==0);
+
+    MU_CHECK(bej_colset_add(&C, a, an)==1);
+    MU_CHECK(bej_colset_add(&C, b, bn)==1);
+    MU_CHECK(bej_colset_add(&C, a, an-3)==0);   /* truncated: no row added */
+    for(int i=0;i<100;i++) MU_CHECK(bej_colset_add(&C, a, an)==1);
+    MU_ASSERT(C.rows==102);
+
+    MU_CHECK(cnt->i64[0]==7 && cnt->i64[1]==9 && (cnt->valid[0] & 3)==3);
+    MU_CHECK(slot->i64[0]==3 && slot->i64[1]==4);
+    MU_CHECK((name->valid[0] & 3)==1 && name->off[1]==5 && name->off[2]==5 && memcmp(name->data,"dimm0",5)==0);
+    MU_CHECK(name->off[3]==10 && name->data_n==5*101);
+    MU_CHECK((st->valid[0] & 3)==1 && st->idx[0]==1);
+    MU_CHECK((cnt->valid[101>>3] >> (101&7)) & 1);
+
+    FILE* f = tmpfile(); MU_ASSERT(f);
+    MU_CHECK(bej_colset_write(&C, f)==1);
+    long sz = ftell(f); rewind(f);
+    uint8_t h[32]; MU_CHECK(fread(h,1,32,f)==32);
+    MU_CHECK(memcmp(h, BEJ_COL_MAGIC, 4)==0 && h[8]==102 && h[24]==4);
+    MU_CHECK(sz % 8 == 0);
+    fclose(f);
+    bej_colset_free(&C);
+    bej_dict_free(&D);
+}
+
+TEST(test_dict_render){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    MU_ASSERT(D.ent[1].key && D.ent[7].str);
+    MU_CHECK(D.ent[1].key_n==9 && memcmp(D.ent[1].key, "\"Count\": ", 9)==0);
+    MU_CHECK(D.ent[7].str_n==10 && memcmp(D.ent[7].str, "\"Disabled\"", 10)==0);
+
+    /* Unknown member and out-of-range enum ordinal still render as before */
+    uint8_t root[64], out[96], v[4]; size_t rn=0, n=0, vn=0; uint8_t* p;
+    p=root; push_nnint(&p,&rn,2);
+    v[0]=42; push_tuple(&p,&rn,9,BEJ_FMT_INT,v,1);
+    p=v; push_nnint(&p,&vn,5); p=root; push_tuple(&p,&rn,3,BEJ_FMT_ENUM,v,vn);
+    p=out; push_u32le(&p,&n,0xF1F0F000u); push_u16le(&p,&n,0); push_u8(&p,&n,0);
+    push_tuple(&p,&n,0,BEJ_FMT_SET,root,rn);
+    char* js; size_t jn;
+    MU_ASSERT(bej_decode_to_mem(out, n, &D, &js, &jn)==1);
+    const char* want = "{\n      \"seq_9\": 42,\n   \"State\": \"EnumOption\"\n   }\n";
+    MU_CHECK(jn==strlen(want) && memcmp(js, want, jn)==0);
+    free(js);
+    bej_dict_free(&D);
+}
+
+TEST(test_iov_reader){
+    static const uint8_t s0[] = { 0x02 }, s2[] = { 0x34 }, s3[] = { 0x12, 0x05 };
+    bej_iov seg[4] = { { s0, 1 }, { NULL, 0 }, { s2, 1 }, { s3, 2 } };
+    bej_br br; bej_br_init_iov(&br, seg, 4);
+    uint64_t v = 0; uint8_t b = 0;
+    MU_CHECK(bej_br_left(&br)==4);
+    MU_CHECK(bej_read_nnint(&br, &v)==1 && v==0x1234);   /* straddles three segments */
+    MU_CHECK(bej_br_u8(&br, &b)==1 && b==5);
+    MU_CHECK(bej_br_left(&br)==0 && bej_br_u8(&br, &b)==0);
+    MU_CHECK(bej_br_seek(&br, 1)==1 && bej_br_u8(&br, &b)==1 && b==0x34);
+    MU_CHECK(bej_br_seek(&br, 1)==1 && bej_br_skip(&br, 2)==1 && bej_br_u8(&br, &b)==1 && b==5);
+    MU_CHECK(bej_br_seek(&br, 0)==1 && bej_br_skip(&br, 5)==0);
+
+    /* Decoding over every split size matches the contiguous decode */
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    uint8_t a[160]; size_t an = build_test_payload(a, 7, "dimm \"0\" slot\\a", 3, 1);
+    char* want; size_t wn;
+    MU_ASSERT(bej_decode_to_mem(a, an, &D, &want, &wn)==1);
+    bej_iov parts[2*160];
+    for(size_t k=1;k<=an;k++){
+        size_t np = 0;
+        for(size_t off=0; off<an; off+=k){
+            parts[np].d = a+off; parts[np].n = (off+k<=an) ? k : an-off; np++;
+            parts[np].d = NULL; parts[np].n = 0; np++;   /* empty segments are skipped */
+        }
+        bej_jsonw jw; bej_jw_init_mem(&jw);
+        MU_CHECK(bej_decode_iov_to_jsonw(&jw, parts, np, &D)==1);
+        MU_CHECK(jw.len==wn && memcmp(jw.buf, want, wn)==0);
+        free(jw.buf);
+        bej_jw_init_mem(&jw);
+        MU_CHECK(bej_decode_iov_to_jsonw(&jw, parts, np-2, &D)==0);   /* last piece missing */
+        free(jw.buf);
+    }
+    free(want);
+    bej_dict_free(&D);
+}
+
+TEST(test_exact_size){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    static const char* names[] = { NULL, "", "dimm0", "a \"quoted\"\\ name\nwith newline" };
+    static const uint8_t counts[] = { 0, 9, 200, 255 };
+    for(size_t i=0;i<4;i++){
+        uint8_t a[160]; size_t an = build_test_payload(a, counts[i], names[i], (uint8_t)(i*70), (uint8_t)(i&1));
+        char* want; size_t wn, n;
+        MU_ASSERT(bej_decode_to_mem(a, an, &D, &want, &wn)==1);
+        MU_CHECK(bej_decode_size(a, an, &D, &n)==1 && n==wn);   /* escapes, nesting, trailing newline */
+
+        char* got; size_t gn;
+        MU_CHECK(bej_decode_to_mem_exact(a, an, &D, &got, &gn)==1 && gn==wn && memcmp(got, want, wn)==0);
+        free(got);
+
+        const char* path = "test_bej_exact.tmp";
+        MU_CHECK(bej_decode_to_path_exact(path, a, an, &D)==1);
+        FILE* f = fopen(path, "rb"); char fb[512]; size_t fn = 0;
+        if(f){ fn = fread(fb, 1, sizeof(fb), f); fclose(f); }
+        MU_CHECK(fn==wn && memcmp(fb, want, wn)==0);
+        remove(path);
+
+        MU_CHECK(bej_decode_size(a, an-1, &D, &n)==0);      /* truncated */
+        free(want);
+    }
+    bej_dict_free(&D);
+}
+
+TEST(test_int_array_runs){
+    enum { NE = 600 };
+    static uint8_t arr[NE*20], root[NE*20+16], pay[NE*20+32];
+    static char want[NE*24+64];
+    size_t an = 0, rn = 0, pn = 0, wn = 0; uint8_t* p;
+
+    /* Integer elements of every width 0..8 (negative at 8), one string, one
+     * Set (null), one L with a 2-byte nnint; sequence numbers widen past 127 */
+    wn += (size_t)snprintf(want+wn, sizeof(want)-wn, "{\n      \"seq_7\": [");
+    p = arr; push_nnint(&p,&an,NE);
+    for(int i=0;i<NE;i++){
+        if(i) wn += (size_t)snprintf(want+wn, sizeof(want)-wn, ", ");
+        push_nnint(&p,&an,(uint64_t)i<<1);
+        if(i==300){ push_u8(&p,&an,BEJ_FMT_STRING<<4); push_nnint(&p,&an,4); push_cstr(&p,&an,"mid");
+                    wn += (size_t)snprintf(want+wn, sizeof(want)-wn, "\"mid\""); continue; }
+        if(i==301){ push_u8(&p,&an,BEJ_FMT_SET<<4); push_nnint(&p,&an,1); push_u8(&p,&an,0);
+                    wn += (size_t)snprintf(want+wn, sizeof(want)-wn, "null"); continue; }
+        size_t w = (size_t)i % 9; uint64_t v = 0;
+        push_u8(&p,&an,BEJ_FMT_INT<<4);
+        if(i==450){ push_u8(&p,&an,2); push_u8(&p,&an,(uint8_t)w); push_u8(&p,&an,0); }
+        else push_nnint(&p,&an,w);
+        for(size_t j=0;j<w;j++){
+            uint8_t b = (w==8 && j==7) ? 0xF0 : (uint8_t)(i*37 + (int)j*11);
+            push_u8(&p,&an,b); v |= (uint64_t)b << (8*j);
+        }
+        wn += (size_t)snprintf(want+wn, sizeof(want)-wn, "%lld", (long long)v);
+    }
+    wn += (size_t)snprintf(want+wn, sizeof(want)-wn, "]\n   }\n");
+    p = root; push_nnint(&p,&rn,1); push_tuple(&p,&rn,7,BEJ_FMT_ARRAY,arr,an);
+    p = pay; push_u32le(&p,&pn,0xF1F0F000u); push_u16le(&p,&pn,0); push_u8(&p,&pn,0);
+    push_tuple(&p,&pn,0,BEJ_FMT_SET,root,rn);
+
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    char* got; size_t gn, sz;
+    MU_ASSERT(bej_decode_to_mem(pay, pn, &D, &got, &gn)==1);
+    MU_CHECK(gn==wn && memcmp(got, want, wn)==0);
+    free(got);
+    MU_CHECK(bej_decode_size(pay, pn, &D, &sz)==1 && sz==wn);
+
+    /* Runs cut by segment boundaries finish on the per-element path */
+    for(size_t cut=1; cut<pn; cut+=37){
+        bej_iov seg[2] = { { pay, cut }, { pay+cut, pn-cut } };
+        bej_jsonw jw; bej_jw_init_mem(&jw);
+        MU_CHECK(bej_decode_iov_to_jsonw(&jw, seg, 2, &D)==1 && jw.len==wn && memcmp(jw.buf, want, wn)==0);
+        free(jw.buf);
+        MU_CHECK(bej_decode_to_mem(pay, cut, &D, &got, &gn)==0);   /* truncated */
+    }
+    bej_dict_free(&D);
+}
+
+TEST(test_prom_export){
+    uint8_t dict[256]; size_t dn = build_test_dict(dict);
+    bej_dict D; MU_ASSERT(bej_dict_load(dict, dn, &D)==1);
+    static const char map[] =
+        "# path   metric            type     options\n"
+        "\n"
+        "Count    bej_count_total   counter\n"
+        "Loc/Slot bej_slot{k=\"a\\\"b\"}\r\n"
+        "State    bej_state         Enabled=1 Disabled=0.5\n";
+    size_t line = 99;
+    bej_prom* P = bej_prom_new(&D, map, sizeof(map)-1, &line);
+    MU_ASSERT(P!=NULL);
+    MU_CHECK(line==0);
+
+    uint8_t a[160], b[160];
+    size_t an = build_test_payload(a, 7, "dimm0", 3, 1);
+    size_t bn = build_test_payload(b, 9, NULL, 4, 0);
+    MU_CHECK(bej_prom_add(P, a, an, "res=\"r1\"")==1);
+    MU_CHECK(bej_prom_add(P, b, bn, NULL)==1);
+    MU_CHECK(bej_prom_add(P, a, an-2, "res=\"bad\"")==0);   /* truncated: no samples kept */
+    MU_CHECK(bej_prom_pending(P)==6);
+
+    static const char want[] =
+        "# TYPE bej_count counter\n"
+        "bej_count_total{res=\"r1\"} 7\n"
+        "bej_count_total 9\n"
+        "# TYPE bej_slot gauge\n"
+        "bej_slot{k=\"a\\\"b\",res=\"r1\"} 3\n"
+        "bej_slot{k=\"a\\\"b\"} 4\n"
+        "# TYPE bej_state gauge\n"
+        "bej_state{res=\"r1\"} 0.5\n"
+        "bej_state 1\n"
+        "# EOF\n";
+    FILE* f = tmpfile(); MU_ASSERT(f!=NULL);
+    MU_CHECK(bej_prom_write(P, f)==1);
+    MU_CHECK(bej_prom_pending(P)==0);
+    char got[512]; rewind(f); size_t gn = fread(got, 1, sizeof(got), f); fclose(f);
+    MU_CHECK(gn==sizeof(want)-1 && memcmp(got, want, gn)==0);
+    bej_prom_free(P);
+
+    /* Invalid mappings report their line */
+    static const char* bad[] = {
+        "Name bej_name\n",                      /* String property */
+        "Count ok\nLoc bej_loc\n",              /* Set property */
+        "Nope bej_x\n",                         /* unknown path */
+        "Count bej_c{k=v}\n",                   /* unquoted label value */
+        "Count 1bad\n",                         /* metric name */
+        "State bej_s Unknown=1\n",              /* unknown option */
+        "State bej_s Enabled=x\n",              /* not a number */
+        "Count bej_c Enabled=1\n",              /* options on an Integer */
+        "Count bej_c\nCount bej_d\n",           /* path mapped twice */
+        "Count bej_c counter\nLoc/Slot bej_c\n",/* family type conflict */
+    };
+    static const size_t bad_line[] = { 1, 2, 1, 1, 1, 1, 1, 1, 2, 2 };
+    for(size_t i=0;i<sizeof(bad)/sizeof(bad[0]);i++){
+        line = 0;
+        MU_CHECK(bej_prom_new(&D, bad[i], strlen(bad[i]), &line)==NULL && line==bad_line[i]);
+    }
+    bej_dict_free(&D);
+}
+
 /* --------------------- runner --------------------- */
 int main(void){
     int before;
 
     before = g_failures; RUN_TEST(test_nnint_basic);
     before = g_failures; RUN_TEST(test_dict_load_lookup);
+    before = g_failures; RUN_TEST(test_delta_patch);
+    before = g_failures; RUN_TEST(test_cache_lru);
+    before = g_failures; RUN_TEST(test_pred_eval);
+    before = g_failures; RUN_TEST(test_arc_roundtrip);
+    before = g_failures; RUN_TEST(test_large_lengths);
+    before = g_failures; RUN_TEST(test_dict_wide);
+    before = g_failures; RUN_TEST(test_colset);
+    before = g_failures; RUN_TEST(test_dict_render);
+    before = g_failures; RUN_TEST(test_iov_reader);
+    before = g_failures; RUN_TEST(test_exact_size);
+    before = g_failures; RUN_TEST(test_int_array_runs);
+    before = g_failures; RUN_TEST(test_prom_export);
 
     if(g_failures){
         fprintf(stderr, "\nFAILED: %d test(s)\n", g_failures);
@@ -0,0 +1,131 @@
+/* tests/test_codegen_c.c
+ * The decoder generated by bej_codegen from Memory_v1.bin must produce the
+ * same bytes as the generic decoder: on the sample payload and on payloads
+ * synthesized from the dictionary (all members, nested Sets, annotations,
+ * unknown sequence numbers, mismatched formats, escapes, truncation) and on
+ * 8-byte negative Integers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/bej.h"
+#include "bej_gen.h"
+#include "bej_memory_v1.h"
+
+/* --------------------- tiny test "framework" --------------------- */
+
+static int g_failures = 0;
+#define MU_ASSERT(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+        return; \
+    } \
+} while(0)
+
+#define TEST(name) static void name(void)
+#define RUN_TEST(fn) do { \
+    fprintf(stdout, "[RUN ] %s\n", #fn); \
+    fn(); \
+    if(g_failures==before) fprintf(stdout, "[ OK ] %s\n", #fn); \
+    else fprintf(stdout, "[ NG ] %s\n", #fn); \
+} while(0)
+
+/* --------------------- helpers --------------------- */
+
+static int load_file(const char* name, uint8_t** out, size_t* out_n){
+    char path[1024]; snprintf(path, sizeof(path), "%s/%s", BEJ_DATA_DIR, name);
+    *out=NULL; *out_n=0; FILE* f=fopen(path,"rb"); if(!f) return 0;
+    fseek(f,0,SEEK_END); long sz=ftell(f); fseek(f,0,SEEK_SET);
+    if(sz<=0){ fclose(f); return 0; }
+    uint8_t* buf=(uint8_t*)malloc((size_t)sz);
+    if(!buf || fread(buf,1,(size_t)sz,f)!=(size_t)sz){ free(buf); fclose(f); return 0; }
+    fclose(f); *out=buf; *out_n=(size_t)sz; return 1;
+}
+
+/* Both decoders agree on success and, when they succeed, on every byte */
+static int same_output(const uint8_t* p, size_t n, const bej_dict* D){
+    char *a, *b; size_t an, bn;
+    int ra = bej_decode_to_mem(p, n, D, &a, &an);
+    int rb = bej_memory_v1_decode_to_mem(p, n, &b, &bn);
+    int same = ra==rb && (!ra || (an==bn && memcmp(a,b,an)==0));
+    if(!same) fprintf(stderr, "  generic %d (%zu bytes) vs generated %d (%zu bytes)\n", ra, ra?an:0, rb, rb?bn:0);
+    if(ra) free(a);
+    if(rb) free(b);
+    return same;
+}
+
+static uint8_t* g_sb; static size_t g_sn;
+static bej_dict g_D;
+
+/* --------------------- tests --------------------- */
+
+TEST(test_codegen_sample){
+    MU_ASSERT(g_D.id == bej_memory_v1_dict_id);
+    uint8_t* p; size_t n;
+    MU_ASSERT(load_file("example.bin", &p, &n));
+    MU_ASSERT(same_output(p, n, &g_D));
+    char* js; size_t jn;
+    MU_ASSERT(bej_memory_v1_decode_to_mem(p, n, &js, &jn));
+    MU_ASSERT(jn > 0 && js[0]=='{');
+    free(js); free(p);
+}
+
+TEST(test_codegen_synth){
+    gen_buf pb = {0};
+    for(uint64_t seed=1; seed<=500; seed++){
+        gen_payload_dict(&pb, &g_D, seed);
+        MU_ASSERT(same_output(pb.d, pb.n, &g_D));
+    }
+    gen_buf_free(&pb);
+}
+
+TEST(test_codegen_truncated){
+    gen_buf pb = {0};
+    for(uint64_t seed=1; seed<=20; seed++){
+        gen_payload_dict(&pb, &g_D, seed);
+        for(size_t cut=0; cut<pb.n; cut+=1 + pb.n/97) MU_ASSERT(same_output(pb.d, cut, &g_D));
+    }
+    gen_buf_free(&pb);
+}
+
+/* 8-byte Integers with the top bit set render as negative numbers in both */
+TEST(test_codegen_negative){
+    const bej_dict_entry* de = bej_cluster_lookup_name(&g_D, bej_dict_child_cluster(&g_D, &g_D.ent[0]), "CapacityMiB", 11);
+    MU_ASSERT(de != NULL);
+    static const uint8_t neg[8] = { 0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF };
+    gen_buf root = {0}, pb = {0};
+    gen_nnint(&root, 1); gen_tuple(&root, de->seq, BEJ_FMT_INT, neg, 8);
+    gen_u32le(&pb, 0xF1F0F000u); gen_u16le(&pb, 0); gen_u8(&pb, 0);
+    gen_tuple(&pb, 0, BEJ_FMT_SET, root.d, root.n);
+    MU_ASSERT(same_output(pb.d, pb.n, &g_D));
+    char* js; size_t jn;
+    MU_ASSERT(bej_memory_v1_decode_to_mem(pb.d, pb.n, &js, &jn));
+    MU_ASSERT(strstr(js, "\"CapacityMiB\": -2") != NULL);
+    free(js); gen_buf_free(&root); gen_buf_free(&pb);
+}
+
+/* --------------------- runner --------------------- */
+
+int main(void){
+    int before;
+    if(!load_file("Memory_v1.bin", &g_sb, &g_sn) || !bej_dict_load(g_sb, g_sn, &g_D)){
+        fprintf(stderr, "cannot load %s/Memory_v1.bin\n", BEJ_DATA_DIR);
+        return 1;
+    }
+    before = g_failures; RUN_TEST(test_codegen_sample);
+    before = g_failures; RUN_TEST(test_codegen_synth);
+    before = g_failures; RUN_TEST(test_codegen_truncated);
+    before = g_failures; RUN_TEST(test_codegen_negative);
+    bej_dict_free(&g_D); free(g_sb);
+
+    if(g_failures){
+        fprintf(stderr, "\nFAILED: %d test(s)\n", g_failures);
+        return 1;
+    }
+    fprintf(stdout, "\nAll tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,204 @@
+/* tests/test_hot_c.c
+ * Hot-reloadable dictionary slot: single-threaded lifecycle, then a stress
+ * run where a reloader keeps swapping two dictionaries while decoder threads
+ * decode through read sections and counted references. Every decode must
+ * match the output of one of the two dictionaries exactly; a decode against
+ * a reclaimed dictionary shows up as a mismatch or (under ASan) a
+ * use-after-free.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/bej.h"
+#include "bej_gen.h"
+
+/* --------------------- tiny test "framework" --------------------- */
+
+static int g_failures = 0;
+#define MU_ASSERT(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+        return; \
+    } \
+} while(0)
+
+#define MU_CHECK(cond) do { \
+    if(!(cond)) { \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while(0)
+
+#define TEST(name) static void name(void)
+#define RUN_TEST(fn) do { \
+    fprintf(stdout, "[RUN ] %s\n", #fn); \
+    fn(); \
+    if(g_failures==before) fprintf(stdout, "[ OK ] %s\n", #fn); \
+    else fprintf(stdout, "[ NG ] %s\n", #fn); \
+} while(0)
+
+/* --------------------- fixtures --------------------- */
+
+/* Dictionary A knows Prop0..Prop39, B knows Prop0..Prop59: members 40..59
+ * of the payload render as "seq_N" under A and by name under B. */
+enum { NA = 40, NB = 60, NPAY = 8, NTHREADS = 8, NRELOAD = 4000 };
+
+static gen_buf g_da, g_db, g_pay[NPAY];
+static char*   g_want[NPAY][2];
+static size_t  g_want_n[NPAY][2];
+
+static int setup(void){
+    if(!gen_dict(&g_da, NA) || !gen_dict(&g_db, NB)) return 0;
+    bej_dict A, B;
+    if(!bej_dict_load(g_da.d, g_da.n, &A)) return 0;
+    if(!bej_dict_load(g_db.d, g_db.n, &B)){ bej_dict_free(&A); return 0; }
+    int ok = 1;
+    for(size_t k=0;k<NPAY;k++){
+        gen_payload(&g_pay[k], NB, k+1);
+        ok &= bej_decode_to_mem(g_pay[k].d, g_pay[k].n, &A, &g_want[k][0], &g_want_n[k][0]);
+        ok &= bej_decode_to_mem(g_pay[k].d, g_pay[k].n, &B, &g_want[k][1], &g_want_n[k][1]);
+    }
+    bej_dict_free(&A); bej_dict_free(&B);
+    return ok;
+}
+
+static void teardown(void){
+    for(size_t k=0;k<NPAY;k++){ free(g_want[k][0]); free(g_want[k][1]); gen_buf_free(&g_pay[k]); }
+    gen_buf_free(&g_da); gen_buf_free(&g_db);
+}
+
+/* 0 or 1 for the dictionary whose output this is, -1 if it matches neither */
+static int which(size_t k, const char* s, size_t n){
+    for(int v=0;v<2;v++) if(n==g_want_n[k][v] && memcmp(s, g_want[k][v], n)==0) return v;
+    return -1;
+}
+
+/* --------------------- tests --------------------- */
+
+TEST(test_slot_lifecycle){
+    bej_dict_slot* s = bej_dict_slot_new(2);
+    MU_ASSERT(s);
+    int r = bej_dict_slot_register(s);
+    MU_ASSERT(r >= 0);
+    MU_CHECK(bej_dict_slot_enter(s, r)==NULL);             /* nothing published yet */
+    bej_dict_slot_leave(s, r);
+
+    MU_ASSERT(bej_dict_slot_publish(s, g_da.d, g_da.n)==1);
+    MU_CHECK(bej_dict_slot_publish(s, g_da.d, 5)==0);      /* malformed: A stays current */
+
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    MU_CHECK(bej_dict_slot_decode_to_jsonw(s, r, &jw, g_pay[0].d, g_pay[0].n)==1 && which(0, jw.buf, jw.len)==0);
+
+    /* A reader inside a section pins A across a reload */
+    const bej_dict* D = bej_dict_slot_enter(s, r);
+    MU_ASSERT(bej_dict_slot_publish(s, g_db.d, g_db.n)==1);
+    MU_CHECK(bej_dict_slot_reclaim(s)==1);
+    jw.len=0; jw.ind=0; jw.need_comma=0;
+    MU_CHECK(D && bej_decode_to_jsonw(&jw, g_pay[0].d, g_pay[0].n, D)==1 && which(0, jw.buf, jw.len)==0);
+    bej_dict_slot_leave(s, r);
+    MU_CHECK(bej_dict_slot_reclaim(s)==0);
+
+    /* A counted reference outlives the reclamation of its version */
+    bej_dict_ref* h = bej_dict_slot_acquire(s, r);
+    MU_ASSERT(h);
+    MU_ASSERT(bej_dict_slot_publish(s, g_da.d, g_da.n)==1);
+    MU_CHECK(bej_dict_slot_reclaim(s)==0);
+    jw.len=0; jw.ind=0; jw.need_comma=0;
+    MU_CHECK(bej_decode_to_jsonw(&jw, g_pay[0].d, g_pay[0].n, bej_dict_ref_get(h))==1 && which(0, jw.buf, jw.len)==1);
+    bej_dict_ref_release(h);
+
+    bej_dict_slot_stats st; bej_dict_slot_get_stats(s, &st);
+    MU_CHECK(st.publishes==3 && st.freed==2 && st.pending==0 && st.readers==1);
+    MU_CHECK(bej_dict_slot_register(s) >= 0 && bej_dict_slot_register(s) < 0);   /* two records */
+    bej_dict_slot_unregister(s, r);
+    free(jw.buf);
+    bej_dict_slot_free(s);
+}
+
+typedef struct {
+    bej_dict_slot* s;
+    atomic_int*    stop;
+    unsigned long  decodes, seen[2], bad;
+} worker;
+
+static void* decode_worker(void* arg){
+    worker* w = (worker*)arg;
+    int r = bej_dict_slot_register(w->s);
+    if(r < 0){ w->bad++; return NULL; }
+    bej_jsonw jw; bej_jw_init_mem(&jw);
+    for(size_t i=0; !atomic_load(w->stop); i++){
+        size_t k = i % NPAY;
+        jw.len=0; jw.ind=0; jw.need_comma=0;
+        int ok;
+        if(i % 4 == 3){
+            bej_dict_ref* h = bej_dict_slot_acquire(w->s, r);
+            ok = h && bej_decode_to_jsonw(&jw, g_pay[k].d, g_pay[k].n, bej_dict_ref_get(h));
+            bej_dict_ref_release(h);
+        } else ok = bej_dict_slot_decode_to_jsonw(w->s, r, &jw, g_pay[k].d, g_pay[k].n);
+        int v = ok ? which(k, jw.buf, jw.len) : -1;
+        if(v < 0) w->bad++; else w->seen[v]++;
+        w->decodes++;
+    }
+    free(jw.buf);
+    bej_dict_slot_unregister(w->s, r);
+    return NULL;
+}
+
+TEST(test_slot_stress){
+    bej_dict_slot* s = bej_dict_slot_new(NTHREADS);
+    MU_ASSERT(s);
+    MU_ASSERT(bej_dict_slot_publish(s, g_da.d, g_da.n)==1);
+    atomic_int stop; atomic_init(&stop, 0);
+    worker w[NTHREADS]; pthread_t t[NTHREADS];
+    memset(w, 0, sizeof(w));
+    for(int i=0;i<NTHREADS;i++){ w[i].s = s; w[i].stop = &stop; MU_ASSERT(pthread_create(&t[i], NULL, decode_worker, &w[i])==0); }
+
+    /* Start reloading once every decoder is registered */
+    bej_dict_slot_stats st;
+    do bej_dict_slot_get_stats(s, &st); while(st.readers < NTHREADS);
+
+    int published = 1;
+    for(int i=0;i<NRELOAD;i++){
+        const gen_buf* d = (i & 1) ? &g_da : &g_db;
+        published += bej_dict_slot_publish(s, d->d, d->n);
+        if(i % 64 == 0) bej_dict_slot_reclaim(s);
+    }
+    atomic_store(&stop, 1);
+    unsigned long decodes = 0, seen0 = 0, seen1 = 0, bad = 0;
+    for(int i=0;i<NTHREADS;i++){
+        pthread_join(t[i], NULL);
+        decodes += w[i].decodes; seen0 += w[i].seen[0]; seen1 += w[i].seen[1]; bad += w[i].bad;
+    }
+    printf("  %d reloads, %lu decodes (%lu A, %lu B) on %d threads\n", NRELOAD, decodes, seen0, seen1, NTHREADS);
+    MU_CHECK(bad == 0);
+    MU_CHECK(published == NRELOAD + 1);
+
+    /* With every reader gone, all replaced dictionaries are reclaimed */
+    MU_CHECK(bej_dict_slot_reclaim(s)==0);
+    bej_dict_slot_get_stats(s, &st);
+    MU_CHECK(st.publishes==(uint64_t)published && st.freed==(uint64_t)NRELOAD && st.readers==0);
+    bej_dict_slot_free(s);
+}
+
+/* --------------------- runner --------------------- */
+
+int main(void){
+    int before;
+    if(!setup()){ fprintf(stderr, "fixture setup failed\n"); return 1; }
+    before = g_failures; RUN_TEST(test_slot_lifecycle);
+    before = g_failures; RUN_TEST(test_slot_stress);
+    teardown();
+
+    if(g_failures){
+        fprintf(stderr, "\nFAILED: %d test(s)\n", g_failures);
+        return 1;
+    }
+    fprintf(stdout, "\nAll tests passed.\n");
+    return 0;
+}